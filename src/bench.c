@@ -0,0 +1,738 @@
+/* bench.c, Synthetic game library generator and benchmark of scraping, sorting and filtering for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#include "fstools.h"
+#include "ini.h"
+#include "timers.h"
+#include "platform.h"
+#include "filter.h"
+#include "query.h"
+#ifndef __HAS_BMP
+#include "bmp.h"
+#define __HAS_BMP
+#endif
+
+#define BENCH_DIR		"BENCH"		// Created under the current directory to hold the synthetic game libraries
+#define BENCH_GAMES		5000		// Default number of synthetic game directories
+#define BENCH_GAMES_MIN	100			// Smallest library that can be generated
+#define BENCH_GAMES_MAX	20000		// Largest library that can be generated
+#define BENCH_PARSES		10000	// Number of launch.dat files parsed by each launch.dat handler
+#define BENCH_SEED		1991		// Seed of the random numbers the library is generated from
+#define BENCH_ART		"ART.BMP"	// Artwork written to each game directory
+#define BENCH_ART_COLS	32			// Width of the artwork, a multiple of 4 so rows need no padding
+#define BENCH_ART_ROWS	24			// Height of the artwork
+#define BENCH_PER_SERIES	20			// Games for each series in the library, at the least the list below
+#define BENCH_PER_COMPANY	10			// Games for each company in the library, at the least the list below
+
+// A launch.dat with every key set, last key of each section last, as the worst case for a MATCH chain
+static char *bench_launchdat = 
+	"[default]\n"
+	"name=Wing Commander II\n"
+	"developer=Origin Systems\n"
+	"publisher=Origin Systems\n"
+	"genre=Space Combat\n"
+	"series=Wing Commander\n"
+	"year=1991\n"
+	"midi_mpu=1\n"
+	"midi_serial=0\n"
+	"start=wc2.exe\n"
+	"alt_start=install.exe\n"
+	"images=wc2_1.bmp,wc2_2.bmp\n"
+	"[sound]\n"
+	"beeper=1\n"
+	"tandy=0\n"
+	"adlib=1\n"
+	"soundblaster=1\n"
+	"mt32=1\n"
+	"gm=0\n"
+	"covox=0\n"
+	"disney=0\n"
+	"ultrasound=0\n"
+	"[video]\n"
+	"text=0\n"
+	"hercules=0\n"
+	"tandy=0\n"
+	"cga=0\n"
+	"ega=1\n"
+	"vga=1\n"
+	"svga=0\n"
+	"[cpu]\n"
+	"8086=0\n"
+	"286=1\n"
+	"386=1\n"
+	"486=1\n"
+	"586=1\n"
+	"xms=0\n"
+	"ems=1\n"
+	"dpmi=0\n";
+
+static int bench_MatchHandler(void* user, const char* section, const char* name, const char* value){
+	/* The launch.dat handler as it was before the key table, one MATCH per key, kept to compare against */
+	
+	launchdat_t* launchdat = (launchdat_t*)user;
+		
+	#define MATCH(s, n) strcmp(section, s) == 0 && strcmp(name, n) == 0
+	if (MATCH("default", "name")){
+		strncpy(launchdat->realname, value, MAX_NAME_SIZE - 1);
+		
+	} else if (MATCH("default", "genre")){
+		strncpy(launchdat->genre, value, MAX_STRING_SIZE - 1);
+		
+	} else if (MATCH("default", "developer")){
+		strncpy(launchdat->developer, value, MAX_STRING_SIZE - 1);
+		
+	} else if (MATCH("default", "publisher")){
+		strncpy(launchdat->publisher, value, MAX_STRING_SIZE - 1);
+		
+	} else if (MATCH("default", "year")){
+		launchdat->year = atoi(value);
+		
+	} else if (MATCH("default", "midi_mpu")){
+		if (atoi(value) == 1){
+			launchdat->midi = 1;
+		}
+	} else if (MATCH("default", "midi_serial")){
+		if (atoi(value) == 1){
+			launchdat->midi_serial = 1;
+		}
+	} else if (MATCH("default", "start")){
+		strncpy(launchdat->start, value, MAX_FILENAME_SIZE - 1);
+	
+	} else if (MATCH("default", "alt_start")){
+		strncpy(launchdat->alt_start, value, MAX_FILENAME_SIZE - 1);
+		
+	} else if (MATCH("default", "images")){
+		strncpy(launchdat->images, value, IMAGE_BUFFER_SIZE - 1);
+		
+	} else if (MATCH("default", "series")){
+		strncpy(launchdat->series, value, MAX_STRING_SIZE - 1);
+	// audio hardware metadata 
+	} else if (MATCH("sound", "beeper")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_BEEPER;
+		}
+	} else if (MATCH("sound", "tandy")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_TANDY_AUDIO;
+		}
+	} else if (MATCH("sound", "adlib")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_ADLIB;
+		}
+	} else if (MATCH("sound", "soundblaster")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_SOUNDBLASTER;
+		}
+	} else if (MATCH("sound", "mt32")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_MT32;
+		}
+	} else if (MATCH("sound", "gm")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_GM;
+		}
+	} else if (MATCH("sound", "covox")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_COVOX;
+		}
+	} else if (MATCH("sound", "disney")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_DISNEY;
+		}
+	} else if (MATCH("sound", "ultrasound")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_ULTRASOUND;
+		}
+	// video hardware metadata
+	} else if (MATCH("video", "text")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_TEXT;
+		}
+	} else if (MATCH("video", "hercules")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_HERCULES;
+		}
+	} else if (MATCH("video", "tandy")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_TANDY_VIDEO;
+		}
+	} else if (MATCH("video", "cga")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_CGA;
+		}
+	} else if (MATCH("video", "ega")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_EGA;
+		}
+	} else if (MATCH("video", "vga")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_VGA;
+		}
+	} else if (MATCH("video", "svga")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_SVGA;
+		}	
+	// cpu/misc hardware metadata
+	} else if (MATCH("cpu", "8086")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_CPU_8086;
+		}
+	} else if (MATCH("cpu", "286")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_CPU_286;
+		}
+	} else if (MATCH("cpu", "386")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_CPU_386;
+		}
+	} else if (MATCH("cpu", "486")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_CPU_486;
+		}
+	} else if (MATCH("cpu", "586")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_CPU_586;
+		}
+	} else if (MATCH("cpu", "xms")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_RAM_XMS;
+		}
+	} else if (MATCH("cpu", "ems")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_RAM_EMS;
+		}
+	} else if (MATCH("cpu", "dpmi")){
+		if (atoi(value) == 1){
+			launchdat->hardware |= HW_DPMI;
+		}
+	} else {
+		return 0;  /* unknown section/name, error */
+	}
+	return 1;
+}
+
+// Word lists the synthetic library is made from
+static char *bench_genres[] = {
+	"Action", "Adventure", "Arcade", "Fighting", "FPS", "Platform", "Puzzle",
+	"Racing", "RPG", "Shooter", "Simulation", "Space Combat", "Sports", "Strategy"
+};
+static char *bench_series[] = {
+	"Commander Keen", "Wing Commander", "Ultima", "Kings Quest", "Space Quest",
+	"Monkey Island", "Doom", "Duke Nukem", "Lemmings", "Civilization", "Command & Conquer",
+	"Jazz Jackrabbit", "Jill of the Jungle", "Prince of Persia", "Test Drive", "Warcraft"
+};
+static char *bench_companies[] = {
+	"Apogee", "Bullfrog", "Blizzard", "Epic MegaGames", "id Software", "Infocom",
+	"LucasArts", "MicroProse", "Origin Systems", "Psygnosis", "Sierra On-Line",
+	"SSI", "Westwood Studios", "Accolade", "Broderbund", "Electronic Arts",
+	"Interplay", "Gremlin Graphics", "Ocean", "Team17"
+};
+static char *bench_adjectives[] = {
+	"Ancient", "Burning", "Crimson", "Dark", "Eternal", "Frozen", "Galactic",
+	"Hidden", "Iron", "Last", "Lost", "Mega", "Neon", "Quantum", "Secret", "Super"
+};
+static char *bench_nouns[] = {
+	"Arena", "Blaster", "Castle", "Commando", "Dungeon", "Empire", "Fortress",
+	"Galaxy", "Knight", "Legend", "Odyssey", "Quest", "Racer", "Saga", "Warrior", "Wizard"
+};
+static char *bench_sound[] = {
+	"beeper", "tandy", "adlib", "soundblaster", "mt32", "gm", "covox", "disney", "ultrasound"
+};
+static char *bench_video[] = {
+	"text", "hercules", "tandy", "cga", "ega", "vga", "svga"
+};
+static char *bench_cpu[] = {
+	"8086", "286", "386", "486", "586", "xms", "ems", "dpmi"
+};
+#define BENCH_WORDS(list)	(sizeof(list) / sizeof(list[0]))
+
+static unsigned long bench_seed = BENCH_SEED;		// Fixed, so every run generates the same library
+static int bench_csv = 0;							// Report results as comma separated values
+static int bench_games = BENCH_GAMES;				// Number of games in the library
+
+static unsigned int bench_Random(unsigned int n){
+	/* Return a pseudo-random number from 0 to n - 1; the same sequence on every platform */
+	
+	bench_seed = ((bench_seed * 1103515245UL) + 12345UL) & 0xFFFFFFFFUL;
+	return (unsigned int) ((bench_seed >> 16) & 0x7FFF) % n;
+}
+
+static char * bench_Pick(char *buffer, char **list, unsigned int list_size, unsigned int per_name){
+	/* Pick a random name from a pool which grows with the library, one name for every per_name
+	   games. The first names are the word list itself, the rest are numbered, e.g. "Ultima 3". */
+	
+	unsigned int i;
+	unsigned int pool;
+	
+	pool = bench_games / per_name;
+	if (pool < list_size){
+		pool = list_size;
+	}
+	i = bench_Random(pool);
+	if (i < list_size){
+		return list[i];
+	}
+	sprintf(buffer, "%s %u", list[i % list_size], (i / list_size) + 1);
+	return buffer;
+}
+
+static void bench_Report(char *stage, clock_t start, clock_t end, long int result){
+	/* Print the time taken by one stage, and what it came up with */
+	
+	if (bench_csv){
+		printf("%s,%d,%ld,%ld,%ld\n", stage, bench_games, (long int) (end - start), (long int) ((end - start) / (CLOCKS_PER_SEC / 1000)), result);
+	} else {
+		timers_Print(start, end, stage, 1);
+	}
+}
+
+static void bench_Bytes(char *stage, unsigned long bytes){
+	/* Print an amount of memory, in the same form as a stage that took no time */
+	
+	if (bench_csv){
+		printf("%s,%d,0,0,%lu\n", stage, bench_games, bytes);
+	} else {
+		printf("%s.%d\t %-30s: %5lu bytes\n", __FILE__, __LINE__, stage, bytes);
+	}
+}
+
+static void bench_Put16(FILE *f, unsigned int value){
+	/* Write a little-endian 16bit value */
+	
+	fputc(value & 0xFF, f);
+	fputc((value >> 8) & 0xFF, f);
+}
+
+static void bench_Put32(FILE *f, unsigned long value){
+	/* Write a little-endian 32bit value */
+	
+	bench_Put16(f, (unsigned int) (value & 0xFFFF));
+	bench_Put16(f, (unsigned int) ((value >> 16) & 0xFFFF));
+}
+
+static int bench_WriteArtwork(char *dirname, int game){
+	/* Write a small 8bpp bitmap, with its own palette, as the artwork of a game */
+	
+	int x;
+	int y;
+	unsigned long size;
+	char filepath[MAX_IMAGEPATH_SIZE];
+	FILE *f;
+	
+	sprintf(filepath, "%s\\%s", dirname, BENCH_ART);
+	f = platform_Open(filepath, "wb");
+	if (f == NULL){
+		return -1;
+	}
+	size = (unsigned long) BENCH_ART_COLS * BENCH_ART_ROWS;
+	
+	// File header
+	fputc('B', f);
+	fputc('M', f);
+	bench_Put32(f, 14 + 40 + 1024 + size);
+	bench_Put32(f, 0);
+	bench_Put32(f, 14 + 40 + 1024);
+	
+	// DIB header
+	bench_Put32(f, 40);
+	bench_Put32(f, BENCH_ART_COLS);
+	bench_Put32(f, BENCH_ART_ROWS);
+	bench_Put16(f, 1);
+	bench_Put16(f, 8);
+	bench_Put32(f, 0);
+	bench_Put32(f, size);
+	bench_Put32(f, 2835);
+	bench_Put32(f, 2835);
+	bench_Put32(f, 256);
+	bench_Put32(f, 0);
+	
+	// Palette, as blue, green, red, reserved
+	for (x = 0; x < 256; x++){
+		fputc(x, f);
+		fputc((x + game) & 0xFF, f);
+		fputc(255 - x, f);
+		fputc(0, f);
+	}
+	
+	// Pixels; rows are already a multiple of 4 bytes, so need no padding
+	for (y = 0; y < BENCH_ART_ROWS; y++){
+		for (x = 0; x < BENCH_ART_COLS; x++){
+			fputc(((x ^ y) + game) & 0xFF, f);
+		}
+	}
+	fclose(f);
+	return 0;
+}
+
+static int bench_WriteLaunchdat(char *dirname, int game){
+	/* Write a launch.dat with a made-up name, and a random genre, series, companies and hardware */
+	
+	unsigned int i;
+	char developer[MAX_STRING_SIZE];
+	char publisher[MAX_STRING_SIZE];
+	char series[MAX_STRING_SIZE];
+	char *name = NULL;
+	char filepath[MAX_IMAGEPATH_SIZE];
+	FILE *f;
+	
+	sprintf(filepath, "%s\\%s", dirname, GAMEDAT);
+	f = platform_Open(filepath, "w");
+	if (f == NULL){
+		return -1;
+	}
+	
+	fprintf(f, "[default]\n");
+	fprintf(f, "name=%s %s", bench_adjectives[bench_Random(BENCH_WORDS(bench_adjectives))], bench_nouns[bench_Random(BENCH_WORDS(bench_nouns))]);
+	if (bench_Random(3) == 0){
+		fprintf(f, " %u", bench_Random(5) + 2);
+	}
+	fprintf(f, "\n");
+	
+	// Most games are published by someone other than the developer
+	name = bench_Pick(developer, bench_companies, BENCH_WORDS(bench_companies), BENCH_PER_COMPANY);
+	fprintf(f, "developer=%s\n", name);
+	if (bench_Random(3) != 0){
+		name = bench_Pick(publisher, bench_companies, BENCH_WORDS(bench_companies), BENCH_PER_COMPANY);
+	}
+	fprintf(f, "publisher=%s\n", name);
+	fprintf(f, "genre=%s\n", bench_genres[bench_Random(BENCH_WORDS(bench_genres))]);
+	
+	// Only some games are part of a series
+	if (bench_Random(5) < 2){
+		fprintf(f, "series=%s\n", bench_Pick(series, bench_series, BENCH_WORDS(bench_series), BENCH_PER_SERIES));
+	}
+	fprintf(f, "year=%u\n", 1981 + bench_Random(19));
+	
+	// Every game starts from a file of its own
+	fprintf(f, "start=G%07d.EXE\n", game);
+	if (bench_Random(4) == 0){
+		fprintf(f, "alt_start=SETUP.EXE\n");
+	}
+	fprintf(f, "images=%s\n", BENCH_ART);
+	
+	fprintf(f, "[sound]\n");
+	for (i = 0; i < BENCH_WORDS(bench_sound); i++){
+		fprintf(f, "%s=%u\n", bench_sound[i], (bench_Random(3) == 0) ? 1 : 0);
+	}
+	fprintf(f, "[video]\n");
+	for (i = 0; i < BENCH_WORDS(bench_video); i++){
+		fprintf(f, "%s=%u\n", bench_video[i], (bench_Random(3) == 0) ? 1 : 0);
+	}
+	fprintf(f, "[cpu]\n");
+	for (i = 0; i < BENCH_WORDS(bench_cpu); i++){
+		fprintf(f, "%s=%u\n", bench_cpu[i], (bench_Random(3) == 0) ? 1 : 0);
+	}
+	fclose(f);
+	return 0;
+}
+
+static int bench_MakeLibrary(char *path, int games){
+	/* Create a search path holding a number of game directories, each with a launch.dat and
+	   artwork. A library of the same size is only generated once, and reused after that. */
+	
+	int i;
+	char dirname[MAX_GAMEPATH_SIZE];
+	
+	if (isDir(path)){
+		return 0;
+	}
+	platform_MakeDir(path);
+	for (i = 0; i < games; i++){
+		sprintf(dirname, "%s\\G%07d", path, i);
+		if (platform_MakeDir(dirname) != 0){
+			printf("%s.%d\t Unable to create %s\n", __FILE__, __LINE__, dirname);
+			return -1;
+		}
+		if ((bench_WriteLaunchdat(dirname, i) != 0) || (bench_WriteArtwork(dirname, i) != 0)){
+			printf("%s.%d\t Unable to write game files under %s\n", __FILE__, __LINE__, dirname);
+			return -1;
+		}
+	}
+	return games;
+}
+
+static int bench_SelectFilter(state_t *state, char *filter_string){
+	/* Select a filter string by name, returns its position or -1 if it isn't in the list */
+	
+	unsigned int i;
+	
+	for (i = 0; i < state->available_filter_strings; i++){
+		if (strcmp(state->filter_strings[i], filter_string) == 0){
+			state->filter_strings_selected[i] = 1;
+			return i;
+		}
+	}
+	return -1;
+}
+
+int main(int argc, char **argv){
+	
+	int i;
+	int found;
+	long int result;
+	clock_t start_time, end_time;
+	char cwd[DIR_BUFFER_SIZE];
+	char filepath[MAX_IMAGEPATH_SIZE];
+	char name[MAX_NAME_SIZE];
+	char game_path[MAX_GAMEPATH_SIZE];
+	config_t config;
+	gamedir_t gamedir;
+	gamedata_t head;
+	gamedata_t *gamedata = NULL;
+	launchdat_t *launchdat = NULL;
+	launchdat_t *matchdat = NULL;
+	state_t *state = NULL;
+	bmpdata_t *bmpdata = NULL;
+	arena_stats_t arena_stats;
+	FILE *f;
+	
+	// bench [games] [-csv]
+	for (i = 1; i < argc; i++){
+		if (strcmp(argv[i], "-csv") == 0){
+			bench_csv = 1;
+		} else {
+			bench_games = atoi(argv[i]);
+		}
+	}
+	if ((bench_games < BENCH_GAMES_MIN) || (bench_games > BENCH_GAMES_MAX)){
+		printf("Number of games must be from %d to %d\n", BENCH_GAMES_MIN, BENCH_GAMES_MAX);
+		return -1;
+	}
+	
+	memset(&config, 0, sizeof(config_t));
+	memset(&gamedir, 0, sizeof(gamedir_t));
+	memset(&head, 0, sizeof(gamedata_t));
+	config.preload_names = 1;
+	launchdat = (launchdat_t *) calloc(sizeof(launchdat_t), 1);
+	matchdat = (launchdat_t *) calloc(sizeof(launchdat_t), 1);
+	state = (state_t *) calloc(sizeof(state_t), 1);
+	bmpdata = (bmpdata_t *) calloc(sizeof(bmpdata_t), 1);
+	if ((launchdat == NULL) || (matchdat == NULL) || (state == NULL) || (bmpdata == NULL)){
+		printf("%s.%d\t Unable to allocate memory\n", __FILE__, __LINE__);
+		return -1;
+	}
+	
+	// Each size of library has a directory of its own, e.g. BENCH\05000
+	platform_GetDir(cwd, DIR_BUFFER_SIZE);
+	if ((strlen(cwd) + strlen("\\" BENCH_DIR "\\00000")) >= MAX_PATH_SIZE){
+		printf("Current directory is too long to hold the libraries [%s]\n", cwd);
+		return -1;
+	}
+	sprintf(gamedir.path, "%s\\%s", cwd, BENCH_DIR);
+	if (strlen(cwd) == 3){
+		// Already has a trailing backslash, e.g. "C:\"
+		sprintf(gamedir.path, "%s%s", cwd, BENCH_DIR);
+	}
+	platform_MakeDir(gamedir.path);
+	sprintf(gamedir.path + strlen(gamedir.path), "\\%05d", bench_games);
+	
+	if (bench_csv){
+		printf("stage,games,ticks,ms,result\n");
+	} else {
+		printf("Library of %d games under %s...\n", bench_games, gamedir.path);
+	}
+	start_time = clock();
+	result = bench_MakeLibrary(gamedir.path, bench_games);
+	end_time = clock();
+	if (result < 0){
+		return -1;
+	}
+	bench_Report("Library", start_time, end_time, result);
+	
+	// Scrape the search path, as at startup
+	start_time = clock();
+	found = findDirs(&gamedir, &head, 0, &config, launchdat, NULL);
+	end_time = clock();
+	bench_Report("Game Scraping", start_time, end_time, found);
+	
+	// Load the real name of every game, as the main loop does while idle
+	result = 0;
+	start_time = clock();
+	gamedata = head.next;
+	while (gamedata != NULL){
+		strcpy(name, gamedata->name);
+		if (getLaunchdataName(gamedata, name) == 0){
+			setGameName(gamedata, name);
+			result++;
+		}
+		gamedata = gamedata->next;
+	}
+	end_time = clock();
+	bench_Report("Name Loading", start_time, end_time, result);
+	
+	start_time = clock();
+	sortGamedata(&head, 0);
+	end_time = clock();
+	bench_Report("Game Sorting", start_time, end_time, found);
+	
+	start_time = clock();
+	indexGamedata(&head);
+	end_time = clock();
+	bench_Report("Game Indexing", start_time, end_time, found);
+	
+	// Keyword lists; the first reads every launch.dat, after that metadata comes from memory
+	start_time = clock();
+	filter_GetGenres(state, head.next, launchdat);
+	end_time = clock();
+	bench_Report("Genres (disk)", start_time, end_time, state->available_filter_strings);
+	
+	start_time = clock();
+	filter_GetGenres(state, head.next, launchdat);
+	end_time = clock();
+	bench_Report("Genres (memory)", start_time, end_time, state->available_filter_strings);
+	
+	start_time = clock();
+	filter_GetSeries(state, head.next, launchdat);
+	end_time = clock();
+	bench_Report("Series", start_time, end_time, state->available_filter_strings);
+	
+	start_time = clock();
+	filter_GetCompany(state, head.next, launchdat);
+	end_time = clock();
+	bench_Report("Companies", start_time, end_time, state->available_filter_strings);
+	
+	start_time = clock();
+	filter_GetTechSpecs(state, head.next, launchdat);
+	end_time = clock();
+	bench_Report("Tech Specs", start_time, end_time, state->available_filter_strings);
+	
+	// Every game and its metadata is in the scan arena by now
+	getArenaStats(&arena_stats);
+	bench_Bytes("Arena Used", arena_stats.used);
+	bench_Bytes("Arena Wasted", arena_stats.wasted);
+	
+	// Filter on the first genre, then add a couple of tech specs on top
+	filter_GetGenres(state, head.next, launchdat);
+	state->selected_filter_string = 0;
+	start_time = clock();
+	filter_Genre(state, head.next, launchdat);
+	end_time = clock();
+	bench_Report("Filter Genre", start_time, end_time, state->selected_max);
+	
+	filter_GetTechSpecs(state, head.next, launchdat);
+	bench_SelectFilter(state, FILTER_STRING_AUDIO_ADLIB);
+	bench_SelectFilter(state, FILTER_STRING_VIDEO_VGA);
+	start_time = clock();
+	filter_TechSpecs(state, head.next, launchdat);
+	end_time = clock();
+	bench_Report("Filter Tech Specs", start_time, end_time, state->selected_max);
+	
+	// What filtering holds on to, once every facet has been indexed
+	bench_Bytes("Metadata", getMetadataBytes());
+	bench_Bytes("Query Index", query_Bytes(state));
+	
+	// Read the artwork of every game
+	result = 0;
+	start_time = clock();
+	gamedata = head.next;
+	while (gamedata != NULL){
+		sprintf(filepath, "%s\\%s", getGamePath(gamedata, game_path), BENCH_ART);
+		f = platform_Open(filepath, "rb");
+		if (f != NULL){
+			bmpdata->pixels = NULL;
+			if (bmp_ReadImage(f, bmpdata, 1, 1, 1) == 0){
+				result++;
+			}
+			if (bmpdata->pixels != NULL){
+				free(bmpdata->pixels);
+			}
+			fclose(f);
+		}
+		gamedata = gamedata->next;
+	}
+	end_time = clock();
+	bench_Report("Artwork", start_time, end_time, result);
+	
+	query_Free();
+	freeGamedata();
+	head.next = NULL;
+	
+	// Append the same number of records by walking to the end of the list each time, as scraping used to
+	start_time = clock();
+	for (i = 0; i < bench_games; i++){
+		gamedata = getLastGamedata(&head);
+		gamedata->next = newGamedata();
+		gamedata->next->gameid = i;
+	}
+	end_time = clock();
+	bench_Report("Append (walk)", start_time, end_time, bench_games);
+	removeGamedata(head.next);
+	head.next = NULL;
+	
+	// Append the same number of records at a tracked tail
+	start_time = clock();
+	gamedata = &head;
+	for (i = 0; i < bench_games; i++){
+		gamedata->next = newGamedata();
+		gamedata->next->gameid = i;
+		gamedata = gamedata->next;
+	}
+	end_time = clock();
+	bench_Report("Append (tail)", start_time, end_time, bench_games);
+	
+	// Look up every game by its ID, first by walking the list and then from the index
+	start_time = clock();
+	for (i = 0; i < bench_games; i++){
+		getGameid(i, head.next);
+	}
+	end_time = clock();
+	bench_Report("Lookup (walk)", start_time, end_time, bench_games);
+	start_time = clock();
+	indexGamedata(&head);
+	for (i = 0; i < bench_games; i++){
+		getGameid(i, head.next);
+	}
+	end_time = clock();
+	bench_Report("Lookup (index)", start_time, end_time, bench_games);
+	
+	// Parse the same launch.dat with the old MATCH chain and with the key table
+	start_time = clock();
+	for (i = 0; i < BENCH_PARSES; i++){
+		launchdataDefaults(matchdat);
+		ini_parse_string(bench_launchdat, bench_MatchHandler, matchdat);
+	}
+	end_time = clock();
+	bench_Report("launch.dat (MATCH)", start_time, end_time, BENCH_PARSES);
+	start_time = clock();
+	for (i = 0; i < BENCH_PARSES; i++){
+		launchdataDefaults(launchdat);
+		ini_parse_string(bench_launchdat, launchdatHandler, launchdat);
+	}
+	end_time = clock();
+	bench_Report("launch.dat (table)", start_time, end_time, BENCH_PARSES);
+	if (memcmp(launchdat, matchdat, sizeof(launchdat_t)) != 0){
+		printf("launch.dat handlers disagree!\n");
+	}
+	
+	freeGamedata();
+	free(launchdat);
+	free(matchdat);
+	free(state->selected_list);
+	filter_StringsFree(state);
+	free(state);
+	free(bmpdata);
+	return 0;
+}
@@ -496,11 +496,8 @@ void bmp_Destroy(bmpdata_t *bmpdata){
 }
 
 void bmp_DestroyState(bmpstate_t *bmpstate){
-	// Destroy a bmpstate structure and free any memory allocated
+	// Destroy a bmpstate structure; its row of pixels is part of the structure itself
 	
-	if (bmpstate->pixels != NULL){
-		free(bmpstate->pixels);	
-	}
 	free(bmpstate);	
 }
 
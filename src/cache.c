@@ -0,0 +1,479 @@
+/* cache.c, Persistent on-disk index of scraped game data for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#include "fstools.h"
+#include "cache.h"
+#include "platform.h"
+
+static FILE *cache_file = NULL;						// Open handle of the index, between cache_Open() and cache_Close()
+static cache_header_t cache_header;					// Header of the open index
+static cache_dir_t cache_dirs[MAX_DIRS];				// Search path table of the open index
+static cache_game_t cache_buffer[CACHE_CHUNK];		// Record buffer used for all reads and writes
+
+int cache_Open(config_t *config){
+	/* Open the game index and load its header and search path table */
+	
+	cache_Close();
+	
+	if (config->rescan){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t Rescan forced, ignoring any saved index\n", __FILE__, __LINE__);
+		}
+		return CACHE_ERR;
+	}
+	
+	cache_file = fopen(INDEXFILE, "rb");
+	if (cache_file == NULL){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t No saved index found [%s]\n", __FILE__, __LINE__, INDEXFILE);
+		}
+		return CACHE_ERR;
+	}
+	
+	if (fread(&cache_header, sizeof(cache_header_t), 1, cache_file) != 1){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t Unable to read index header\n", __FILE__, __LINE__);
+		}
+		cache_Close();
+		return CACHE_ERR;
+	}
+	
+	// Anything written by a different build, or with a different name loading setting, is useless to us
+	if ((strncmp(cache_header.magic, CACHE_MAGIC, 4) != 0) || (cache_header.version != CACHE_VERSION) || (cache_header.record_size != sizeof(cache_game_t)) || (cache_header.preload_names != (unsigned short) config->preload_names) || (cache_header.dirs > MAX_DIRS)){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t Index is from an incompatible version or configuration, ignoring\n", __FILE__, __LINE__);
+		}
+		cache_Close();
+		return CACHE_ERR;
+	}
+	
+	if (fread(cache_dirs, sizeof(cache_dir_t), cache_header.dirs, cache_file) != cache_header.dirs){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t Unable to read index search path table\n", __FILE__, __LINE__);
+		}
+		cache_Close();
+		return CACHE_ERR;
+	}
+	
+	if (CACHE_VERBOSE){
+		printf("%s.%d\t Opened index with %d search paths\n", __FILE__, __LINE__, cache_header.dirs);
+	}
+	return CACHE_OK;
+}
+
+static int cache_FindDir(gamedir_t *gamedir, long *offset){
+	/* Return the position of a search path in the table of the open index, and the file offset of its game records */
+	
+	int i;
+	
+	if (cache_file == NULL){
+		return CACHE_ERR;
+	}
+	
+	// Find the search path in the table, totalling up the size of the game records before it
+	*offset = sizeof(cache_header_t) + ((long) cache_header.dirs * sizeof(cache_dir_t));
+	for (i = 0; i < cache_header.dirs; i++){
+		if (strcmp(cache_dirs[i].path, gamedir->path) == 0){
+			return i;
+		}
+		*offset += (long) cache_dirs[i].games * sizeof(cache_game_t);
+	}
+	if (CACHE_VERBOSE){
+		printf("%s.%d\t Search path not in index [%s]\n", __FILE__, __LINE__, gamedir->path);
+	}
+	return CACHE_ERR;
+}
+
+static int cache_ReadGames(int i, long offset, gamedir_t *gamedir, gamedata_t *gamedata, int startnum){
+	/* Append the game records of search path i of the open index to the gamedata list */
+	
+	int c, n;
+	int loaded;
+	gamedata_t *tail = NULL;
+	
+	if (fseek(cache_file, offset, SEEK_SET) != 0){
+		return CACHE_ERR;
+	}
+	
+	tail = getLastGamedata(gamedata);
+	gamedata = tail;
+	loaded = 0;
+	while (loaded < (int) cache_dirs[i].games){
+		n = cache_dirs[i].games - loaded;
+		if (n > CACHE_CHUNK){
+			n = CACHE_CHUNK;
+		}
+		if (fread(cache_buffer, sizeof(cache_game_t), n, cache_file) != (size_t) n){
+			if (CACHE_VERBOSE){
+				printf("%s.%d\t Index truncated, discarding %d records [%s]\n", __FILE__, __LINE__, loaded, gamedir->path);
+			}
+			if (tail->next != NULL){
+				removeGamedata(tail->next);
+				tail->next = NULL;
+			}
+			return CACHE_ERR;
+		}
+		for (c = 0; c < n; c++){
+			// The records come straight off the disk, so make sure their strings end
+			cache_buffer[c].leaf[MAX_FILENAME_SIZE - 1] = '\0';
+			cache_buffer[c].name[MAX_NAME_SIZE - 1] = '\0';
+			gamedata->next = newGamedata();
+			if (gamedata->next == NULL){
+				if (CACHE_VERBOSE){
+					printf("%s.%d\t Unable to allocate memory, discarding %d records [%s]\n", __FILE__, __LINE__, loaded, gamedir->path);
+				}
+				if (tail->next != NULL){
+					removeGamedata(tail->next);
+					tail->next = NULL;
+				}
+				return CACHE_ERR;
+			}
+			gamedata->next->gameid = startnum + loaded;
+			strcpy(gamedata->next->leaf, cache_buffer[c].leaf);
+			setGameName(gamedata->next, cache_buffer[c].name);
+			gamedata->next->has_dat = cache_buffer[c].has_dat;
+			gamedata->next->has_name = cache_buffer[c].has_name;
+			gamedata->next->date = cache_buffer[c].date;
+			gamedata->next->time = cache_buffer[c].time;
+			gamedata->next->dat_size = cache_buffer[c].dat_size;
+			gamedata->next->dat_date = cache_buffer[c].dat_date;
+			gamedata->next->dat_time = cache_buffer[c].dat_time;
+			gamedata->next->dir = gamedir;
+			gamedata->next->next = NULL;
+			gamedata = gamedata->next;
+			loaded++;
+		}
+	}
+	return loaded;
+}
+
+static int cache_SameGame(gamedata_t *gdata, unsigned short date, unsigned short time){
+	/* Returns CACHE_OK if a game from the index still has the same directory stamp, and the
+	   same launch.dat. Adding or editing launch.dat doesn't change the stamp of the game
+	   directory on FAT, so the file itself has to be looked at as well. */
+	
+	// gdata: A game loaded from the index
+	// date, time: Current DOS date and time stamp of the game directory
+	
+	unsigned long dat_size;
+	unsigned short dat_date;
+	unsigned short dat_time;
+	unsigned char has_dat;
+	char game_path[MAX_GAMEPATH_SIZE];
+	
+	if ((gdata->date != date) || (gdata->time != time)){
+		return CACHE_ERR;
+	}
+	has_dat = dirHasData(getGamePath(gdata, game_path), &dat_size, &dat_date, &dat_time);
+	if ((has_dat != gdata->has_dat) || (dat_size != gdata->dat_size) || (dat_date != gdata->dat_date) || (dat_time != gdata->dat_time)){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t %s has changed since it was indexed [%s]\n", __FILE__, __LINE__, GAMEDAT, gdata->leaf);
+		}
+		return CACHE_ERR;
+	}
+	return CACHE_OK;
+}
+
+static int cache_MatchDir(int i, gamedir_t *gamedir, gamedata_t *first){
+	/* Compare the entries of a search path with the games just loaded for search path i of the
+	   open index. Returns CACHE_OK if the entry count is the same and every sub-directory is a
+	   loaded game with an unchanged date and time stamp, and an unchanged launch.dat. */
+	
+	// first: The first of the games loaded for the search path
+	
+	int status;
+	unsigned short entries;
+	unsigned short matched;
+	platform_dir_t *dir;
+	platform_dirent_t *de;
+	gamedata_t *cursor = NULL;
+	gamedata_t *gdata = NULL;
+	
+	dir = platform_OpenDir(gamedir->path);
+	if (dir == NULL){
+		return CACHE_ERR;
+	}
+	
+	status = CACHE_OK;
+	entries = 0;
+	matched = 0;
+	cursor = first;
+	while ((status == CACHE_OK) && ((de = platform_ReadDir(dir)) != NULL)){
+		if ((strcmp(de->name, ".") == 0) || (strcmp(de->name, "..") == 0)){
+			continue;
+		}
+		entries++;
+		if (!de->is_dir){
+			continue;
+		}
+		
+		// Directory entries come back in the same order as the last time they were read,
+		// so start looking just after the last match, wrapping around to the first game
+		status = CACHE_ERR;
+		gdata = cursor;
+		while (gdata != NULL){
+			if (strcmp(gdata->leaf, de->name) == 0){
+				if (cache_SameGame(gdata, de->date, de->time) == CACHE_OK){
+					status = CACHE_OK;
+					matched++;
+				}
+				break;
+			}
+			gdata = (gdata->next != NULL) ? gdata->next : first;
+			if (gdata == cursor){
+				break;
+			}
+		}
+		if (status == CACHE_OK){
+			cursor = (gdata->next != NULL) ? gdata->next : first;
+		}
+	}
+	platform_CloseDir(dir);
+	
+	if ((status != CACHE_OK) || (entries != cache_dirs[i].entries) || (matched != cache_dirs[i].games)){
+		if (CACHE_VERBOSE){
+			printf("%s.%d	 Search path entries have changed since it was indexed [%s]\n", __FILE__, __LINE__, gamedir->path);
+		}
+		return CACHE_ERR;
+	}
+	return CACHE_OK;
+}
+
+int cache_LoadDir(gamedir_t *gamedir, gamedata_t *gamedata, int startnum, config_t *config){
+	/* Append the saved games for a search path to the gamedata list, returning the number added.
+	   Returns CACHE_ERR if the search path needs to be scraped instead. */
+	
+	// gamedir: The search path to load
+	// gamedata: An instance of the linked-list of game data
+	// startnum: The starting number to tag each loaded game with the next auto-incrementing ID
+	
+	int i;
+	int loaded;
+	long offset;
+	gamedata_t *tail = NULL;
+	
+	// Always record the current stamp of the search path, so it is there for cache_Save()
+	if (dirStamp(gamedir->path, &gamedir->date, &gamedir->time) != 0){
+		return CACHE_ERR;
+	}
+	
+	i = cache_FindDir(gamedir, &offset);
+	if (i == CACHE_ERR){
+		return CACHE_ERR;
+	}
+	if ((cache_dirs[i].date != gamedir->date) || (cache_dirs[i].time != gamedir->time)){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t Search path has changed since it was indexed [%s]\n", __FILE__, __LINE__, gamedir->path);
+		}
+		return CACHE_ERR;
+	}
+	
+	tail = getLastGamedata(gamedata);
+	loaded = cache_ReadGames(i, offset, gamedir, tail, startnum);
+	if (loaded == CACHE_ERR){
+		return CACHE_ERR;
+	}
+	
+	// Adding a game directory doesn't change the stamp of the search path on FAT, so
+	// read its entries as well; it is still far quicker than scraping every game again
+	if (cache_MatchDir(i, gamedir, tail->next) != CACHE_OK){
+		if (tail->next != NULL){
+			removeGamedata(tail->next);
+			tail->next = NULL;
+		}
+		return CACHE_ERR;
+	}
+	gamedir->entries = cache_dirs[i].entries;
+	if (CACHE_VERBOSE){
+		printf("%s.%d\t Loaded %d games from index [%s]\n", __FILE__, __LINE__, loaded, gamedir->path);
+	}
+	return loaded;
+}
+
+int cache_LoadPrevious(gamedir_t *gamedir, gamedata_t *previous){
+	/* Load the saved games for a search path which has changed into a seperate list, so
+	   that any game directories which have not changed can be carried over by findDirs() */
+	
+	// gamedir: The search path to load
+	// previous: An empty list head to hold the games from the previous run
+	
+	int i;
+	int loaded;
+	long offset;
+	
+	i = cache_FindDir(gamedir, &offset);
+	if (i == CACHE_ERR){
+		return CACHE_ERR;
+	}
+	
+	loaded = cache_ReadGames(i, offset, gamedir, previous, 0);
+	if ((loaded != CACHE_ERR) && CACHE_VERBOSE){
+		printf("%s.%d\t Loaded %d previous games from index, %d entries were seen last time [%s]\n", __FILE__, __LINE__, loaded, cache_dirs[i].entries, gamedir->path);
+	}
+	return loaded;
+}
+
+gamedata_t * cache_TakeGame(gamedata_t *previous, char *dirname, unsigned short date, unsigned short time){
+	/* Unlink and return the game for a directory name from the list of the previous run, if the
+	   date and time stamp of the directory, and its launch.dat, are unchanged. Returns NULL if
+	   it must be scraped. */
+	
+	// previous: List head of the games from the previous run
+	// dirname: Directory name of the game, e.g. "FINALFGT"
+	// date, time: Current DOS date and time stamp of the game directory
+	
+	gamedata_t *gdata = NULL;
+	
+	// Directory entries come back in the same order as the last time they were
+	// read, so the match is nearly always at the start of the list.
+	while (previous->next != NULL){
+		gdata = previous->next;
+		if (strcmp(gdata->leaf, dirname) == 0){
+			previous->next = gdata->next;
+			gdata->next = NULL;
+			if (cache_SameGame(gdata, date, time) == CACHE_OK){
+				return gdata;
+			}
+			if (CACHE_VERBOSE){
+				printf("%s.%d\t Game directory has changed since it was indexed [%s]\n", __FILE__, __LINE__, gdata->leaf);
+			}
+			removeGamedata(gdata);
+			return NULL;
+		}
+		previous = previous->next;
+	}
+	return NULL;
+}
+
+void cache_Close(){
+	/* Close the game index, if open */
+	
+	if (cache_file != NULL){
+		fclose(cache_file);
+		cache_file = NULL;
+	}
+}
+
+int cache_Save(config_t *config, gamedata_t *gamedata){
+	/* Write every game in the gamedata list to the index, grouped by search path */
+	
+	FILE *f;
+	int n;
+	int gameid;
+	gamedir_t *gamedir = NULL;
+	gamedata_t *gdata = NULL;
+	cache_dir_t dir_record;
+	
+	f = fopen(INDEXFILE, "wb");
+	if (f == NULL){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t Unable to create index [%s]\n", __FILE__, __LINE__, INDEXFILE);
+		}
+		return CACHE_ERR;
+	}
+	
+	memset(&cache_header, 0, sizeof(cache_header_t));
+	memcpy(cache_header.magic, CACHE_MAGIC, 4);
+	cache_header.version = CACHE_VERSION;
+	cache_header.record_size = sizeof(cache_game_t);
+	cache_header.preload_names = config->preload_names;
+	gamedir = config->dir;
+	while (gamedir->next != NULL){
+		gamedir = gamedir->next;
+		cache_header.dirs++;
+	}
+	fwrite(&cache_header, sizeof(cache_header_t), 1, f);
+	
+	// Search path table
+	gamedir = config->dir;
+	while (gamedir->next != NULL){
+		gamedir = gamedir->next;
+		memset(&dir_record, 0, sizeof(cache_dir_t));
+		strcpy(dir_record.path, gamedir->path);
+		dir_record.date = gamedir->date;
+		dir_record.time = gamedir->time;
+		dir_record.entries = gamedir->entries;
+		gdata = gamedata->next;
+		while (gdata != NULL){
+			if (gdata->dir == gamedir){
+				dir_record.games++;
+			}
+			gdata = gdata->next;
+		}
+		fwrite(&dir_record, sizeof(cache_dir_t), 1, f);
+	}
+	
+	// Game records for each search path, in the same order as the table. Within a search path
+	// they are written in gameid order, which is the order the directory entries were found in,
+	// even once the list has been sorted by name; cache_MatchDir() relies on that.
+	gamedir = config->dir;
+	while (gamedir->next != NULL){
+		gamedir = gamedir->next;
+		n = 0;
+		gdata = gamedata->next;
+		for (gameid = 0; ; gameid++){
+			if ((gdata == NULL) || (gdata->gameid != gameid)){
+				gdata = getGameid(gameid, gamedata->next);
+				if (gdata == NULL){
+					break;
+				}
+			}
+			if (gdata->dir == gamedir){
+				memset(&cache_buffer[n], 0, sizeof(cache_game_t));
+				strcpy(cache_buffer[n].leaf, gdata->leaf);
+				strncpy(cache_buffer[n].name, gdata->name, MAX_NAME_SIZE - 1);
+				cache_buffer[n].has_dat = gdata->has_dat;
+				cache_buffer[n].has_name = gdata->has_name;
+				cache_buffer[n].date = gdata->date;
+				cache_buffer[n].time = gdata->time;
+				cache_buffer[n].dat_size = gdata->dat_size;
+				cache_buffer[n].dat_date = gdata->dat_date;
+				cache_buffer[n].dat_time = gdata->dat_time;
+				n++;
+				if (n == CACHE_CHUNK){
+					fwrite(cache_buffer, sizeof(cache_game_t), n, f);
+					n = 0;
+				}
+			}
+			gdata = gdata->next;
+		}
+		if (n > 0){
+			fwrite(cache_buffer, sizeof(cache_game_t), n, f);
+		}
+	}
+	
+	if (fclose(f) != 0){
+		if (CACHE_VERBOSE){
+			printf("%s.%d\t Error writing index [%s]\n", __FILE__, __LINE__, INDEXFILE);
+		}
+		remove(INDEXFILE);
+		return CACHE_ERR;
+	}
+	
+	if (CACHE_VERBOSE){
+		printf("%s.%d\t Saved index of %d search paths [%s]\n", __FILE__, __LINE__, cache_header.dirs, INDEXFILE);
+	}
+	return CACHE_OK;
+}
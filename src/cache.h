@@ -0,0 +1,69 @@
+/* cache.h, Persistent on-disk index of scraped game data for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+
+// Defaults
+#define CACHE_VERBOSE		0			// Enable/disable logging for these functions
+#define CACHE_OK				0			// Success returncode
+#define CACHE_ERR			-1			// Failure returncode, or index entry is missing/stale
+#define CACHE_MAGIC			"XLIX"		// Identifies an index file
+#define CACHE_VERSION		5			// Bump whenever the layout of the records below changes
+#define CACHE_CHUNK			32			// Number of game records read or written in a single call
+
+// Header at the very start of the index file
+typedef struct cache_header {
+	char magic[4];						// CACHE_MAGIC
+	unsigned short version;				// CACHE_VERSION
+	unsigned short record_size;			// sizeof(cache_game_t), sanity check against a differently built binary
+	unsigned short preload_names;		// Whether real names were resolved from launch.dat when the index was written
+	unsigned short dirs;					// Number of cache_dir_t records following the header
+} cache_header_t;
+
+// One per search path, in the order they were written. Game records follow all of the
+// search path records, grouped by search path in the same order.
+typedef struct cache_dir {
+	char path[MAX_PATH_SIZE];			// Search path, as listed in the ini file
+	unsigned short date;				// DOS date stamp of the search path when it was scraped
+	unsigned short time;				// DOS time stamp of the search path when it was scraped
+	unsigned short entries;			// Number of directory entries in the search path when it was scraped
+	unsigned short games;				// Number of game records stored for this search path
+} cache_dir_t;
+
+// One per game found under a search path
+typedef struct cache_game {
+	char leaf[MAX_FILENAME_SIZE];		// Directory name, under the search path it is grouped with
+	char name[MAX_NAME_SIZE];			// Directory name, or real name once it has been loaded
+	char has_dat;						// Flag to indicate launch.dat was found
+	char has_name;						// Whether name is the real name yet, as gamedata_t
+	unsigned short date;				// DOS date stamp of the game directory when it was scraped
+	unsigned short time;				// DOS time stamp of the game directory when it was scraped
+	unsigned long dat_size;			// Size of launch.dat when it was scraped, or 0 if there wasn't one
+	unsigned short dat_date;			// DOS date stamp of launch.dat when it was scraped
+	unsigned short dat_time;			// DOS time stamp of launch.dat when it was scraped
+} cache_game_t;
+
+// Function prototypes
+int		cache_Open(config_t *config);
+int		cache_LoadDir(gamedir_t *gamedir, gamedata_t *gamedata, int startnum, config_t *config);
+int		cache_LoadPrevious(gamedir_t *gamedir, gamedata_t *previous);
+gamedata_t *	cache_TakeGame(gamedata_t *previous, char *dirname, unsigned short date, unsigned short time);
+void	cache_Close();
+int		cache_Save(config_t *config, gamedata_t *gamedata);
@@ -18,8 +18,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <dos.h>
-#include <direct.h>
+#include <stddef.h>
+#include <ctype.h>
 
 #include "ini.h"
 #ifndef __HAS_DATA
@@ -31,10 +31,392 @@
 #include "main.h"
 #define __HAS_MAIN
 #endif
+#include "platform.h"
+
+static arena_block_t *arena_blocks = NULL;			// All blocks of the scan arena allocated so far, newest first
+static unsigned long arena_used = 0;					// Bytes handed out by arenaAlloc(), not counting alignment
+static unsigned long arena_wasted = 0;				// Bytes lost to alignment and to the unused end of full blocks
+static unsigned long arena_metadata = 0;				// Bytes of arena_used holding metadata records and keywords
+static metadata_t metadata_none;						// Shared by every game whose launch.dat couldn't be loaded
+static gamedata_t *gamedata_free = NULL;				// Records returned by removeGamedata(), reused before any new record
+static gamedata_t **gameid_index[GAMEID_BLOCKS];		// Blocks of gamedata record pointers, indexed by gameid
+static int gameid_max = 0;								// Highest indexed gameid, plus one
+
+static keyword_t *keyword_hash[KEYWORD_HASH];		// Hash table of all interned keywords
+static keyword_t **keywords = NULL;					// All interned keywords, indexed by id
+static unsigned int keywords_used = 0;					// Number of ids handed out
+static unsigned int keywords_size = 0;					// Number of ids the keywords table has room for
+
+static void clearGameidIndex(){
+	/* Free all blocks of the gameid index */
+	
+	int i;
+	
+	for (i = 0; i < GAMEID_BLOCKS; i++){
+		if (gameid_index[i] != NULL){
+			free(gameid_index[i]);
+			gameid_index[i] = NULL;
+		}
+	}
+	gameid_max = 0;
+}
+
+static void clearMetadata(){
+	/* Forget the keyword dictionary; the keywords themselves are in the scan arena */
+	
+	if (keywords != NULL){
+		free(keywords);
+	}
+	keywords = NULL;
+	keywords_used = 0;
+	keywords_size = 0;
+	memset(keyword_hash, 0, sizeof(keyword_hash));
+}
+
+static unsigned int hashKeyword(char *value){
+	/* Hash a keyword string to one of the buckets of the dictionary */
+	
+	unsigned int hash;
+	
+	hash = 0;
+	while (*value != '\0'){
+		hash = (hash * 31) + (unsigned char) *value;
+		value++;
+	}
+	return hash % KEYWORD_HASH;
+}
+
+unsigned int findKeyword(char *value){
+	/* Return the id of a keyword string, or KEYWORD_NONE if it is not in the dictionary */
+	
+	keyword_t *keyword = NULL;
+	
+	keyword = keyword_hash[hashKeyword(value)];
+	while (keyword != NULL){
+		if (strcmp(keyword->str, value) == 0){
+			return keyword->id;
+		}
+		keyword = keyword->next;
+	}
+	return KEYWORD_NONE;
+}
+
+unsigned int addKeyword(char *value, int size){
+	/* Return the id of a string of at most size bytes, adding it to the dictionary if it
+	   hasn't been seen before. The empty string is always id 0. Returns KEYWORD_NONE if
+	   there was no memory for it. */
+	
+	char buffer[IMAGE_BUFFER_SIZE];
+	unsigned int hash;
+	unsigned int id;
+	keyword_t *keyword = NULL;
+	keyword_t **resized = NULL;
+	
+	// Fields in the launchdat object are not always terminated if they were filled to the limit
+	strncpy(buffer, value, size);
+	buffer[size - 1] = '\0';
+	
+	// The empty string must be the first id
+	if ((keywords_used == 0) && (buffer[0] != '\0')){
+		if (addKeyword("", 1) == KEYWORD_NONE){
+			return KEYWORD_NONE;
+		}
+	}
+	
+	id = findKeyword(buffer);
+	if (id != KEYWORD_NONE){
+		return id;
+	}
+	
+	if (keywords_used == keywords_size){
+		if (keywords_size >= KEYWORD_MAX){
+			if (DATA_VERBOSE){
+				printf("%s.%d\t addKeyword() Keyword dictionary is full [%s]\n", __FILE__, __LINE__, buffer);
+			}
+			return KEYWORD_NONE;
+		}
+		resized = (keyword_t **) realloc(keywords, (keywords_size + KEYWORD_BLOCK) * sizeof(keyword_t *));
+		if (resized == NULL){
+			if (DATA_VERBOSE){
+				printf("%s.%d\t addKeyword() Unable to grow keyword dictionary [%s]\n", __FILE__, __LINE__, buffer);
+			}
+			return KEYWORD_NONE;
+		}
+		keywords = resized;
+		keywords_size += KEYWORD_BLOCK;
+	}
+	
+	keyword = (keyword_t *) arenaAlloc(sizeof(keyword_t) + strlen(buffer));
+	if (keyword == NULL){
+		if (DATA_VERBOSE){
+			printf("%s.%d\t addKeyword() Unable to allocate keyword [%s]\n", __FILE__, __LINE__, buffer);
+		}
+		return KEYWORD_NONE;
+	}
+	arena_metadata += sizeof(keyword_t) + strlen(buffer);
+	strcpy(keyword->str, buffer);
+	keyword->id = keywords_used;
+	hash = hashKeyword(buffer);
+	keyword->next = keyword_hash[hash];
+	keyword_hash[hash] = keyword;
+	keywords[keywords_used] = keyword;
+	keywords_used++;
+	return keyword->id;
+}
+
+char * getKeyword(unsigned int id){
+	/* Return the string of a keyword id */
+	
+	if (id >= keywords_used){
+		return "";
+	}
+	return keywords[id]->str;
+}
+
+unsigned int getKeywordCount(){
+	/* Return the number of keyword ids handed out, all ids are below this */
+	
+	return keywords_used;
+}
+
+void * arenaAlloc(unsigned int size){
+	/* Return some zeroed space from the scan arena. Everything kept for each game is
+	   carved out of a few large blocks, rather than being allocated one at a time, so that
+	   scraping thousands of games doesn't pay the far heap header and paragraph rounding
+	   of a malloc() per record, nor fragment the heap. Nothing is freed on its own; the
+	   whole arena is released at once by freeGamedata(). */
+	
+	unsigned int pad;
+	unsigned int block_size;
+	char *space = NULL;
+	arena_block_t *block = NULL;
+	
+	pad = (ARENA_ALIGN - (size % ARENA_ALIGN)) % ARENA_ALIGN;
+	if ((arena_blocks == NULL) || ((arena_blocks->size - arena_blocks->used) < (size + pad))){
+		// Anything too big for a normal block gets one of its own
+		block_size = ARENA_BLOCK;
+		if ((size + pad) > block_size){
+			block_size = size + pad;
+		}
+		block = (arena_block_t *) malloc(sizeof(arena_block_t) + block_size);
+		if (block == NULL){
+			if (DATA_VERBOSE){
+				printf("%s.%d\t arenaAlloc() Unable to allocate a new %u byte block\n", __FILE__, __LINE__, block_size);
+			}
+			return NULL;
+		}
+		if (arena_blocks != NULL){
+			arena_wasted += arena_blocks->size - arena_blocks->used;
+		}
+		block->next = arena_blocks;
+		block->size = block_size;
+		block->used = 0;
+		arena_blocks = block;
+	}
+	space = (char *) (arena_blocks + 1) + arena_blocks->used;
+	arena_blocks->used += size + pad;
+	arena_used += size;
+	arena_wasted += pad;
+	memset(space, 0, size);
+	return space;
+}
+
+void getArenaStats(arena_stats_t *stats){
+	/* Add up how much of the scan arena is in use, and how much is wasted */
+	
+	arena_block_t *block = NULL;
+	gamedata_t *gamedata = NULL;
+	
+	memset(stats, 0, sizeof(arena_stats_t));
+	for (block = arena_blocks; block != NULL; block = block->next){
+		stats->blocks++;
+		stats->size += block->size;
+	}
+	for (gamedata = gamedata_free; gamedata != NULL; gamedata = gamedata->next){
+		stats->recycled += sizeof(gamedata_t);
+	}
+	stats->used = arena_used;
+	stats->wasted = arena_wasted;
+	if (arena_blocks != NULL){
+		stats->spare = arena_blocks->size - arena_blocks->used;
+	}
+}
+
+unsigned long getGamedataBytes(){
+	/* Returns the bytes held for the game list: all of the scan arena, including its
+	   block headers and unused space, less the metadata kept in it, plus the gameid index */
+	
+	unsigned long bytes;
+	int i;
+	arena_block_t *block = NULL;
+	
+	bytes = 0;
+	for (block = arena_blocks; block != NULL; block = block->next){
+		bytes += sizeof(arena_block_t) + block->size;
+	}
+	bytes -= arena_metadata;
+	for (i = 0; i < GAMEID_BLOCKS; i++){
+		if (gameid_index[i] != NULL){
+			bytes += GAMEID_BLOCK * sizeof(gamedata_t *);
+		}
+	}
+	return bytes;
+}
+
+unsigned long getMetadataBytes(){
+	/* Returns the bytes held for filter metadata: the metadata records and keywords in
+	   the scan arena, plus the table of keywords by id */
+	
+	return arena_metadata + ((unsigned long) keywords_size * sizeof(keyword_t *));
+}
+
+gamedata_t * newGamedata(){
+	/* Return a new, zeroed gamedata record from the scan arena, reusing any given back
+	   by removeGamedata() first. */
+	
+	gamedata_t *gamedata = NULL;
+	
+	if (gamedata_free != NULL){
+		gamedata = gamedata_free;
+		gamedata_free = gamedata->next;
+		memset(gamedata, 0, sizeof(gamedata_t));
+	} else {
+		gamedata = (gamedata_t *) arenaAlloc(sizeof(gamedata_t));
+		if (gamedata == NULL){
+			if (DATA_VERBOSE){
+				printf("%s.%d\t newGamedata() Unable to allocate a new gamedata record\n", __FILE__, __LINE__);
+			}
+			return NULL;
+		}
+	}
+	gamedata->name = gamedata->leaf;
+	return gamedata;
+}
+
+char * getGamePath(gamedata_t *gamedata, char *buffer){
+	/* Put together the full path of a game directory, e.g. A:\Games\FINALFGT, from its
+	   search path and directory name. The buffer must hold MAX_GAMEPATH_SIZE characters. */
+	
+	if (gamedata->dir == NULL){
+		strcpy(buffer, gamedata->leaf);
+	} else {
+		sprintf(buffer, "%s\\%s", gamedata->dir->path, gamedata->leaf);
+	}
+	return buffer;
+}
+
+int setGameName(gamedata_t *gamedata, char *name){
+	/* Set the name shown for a game. The directory name costs nothing, as the record
+	   already holds it; any other name is kept in the scan arena, taking only as much
+	   space as it needs, and reusing the space of the previous name if it fits. */
+	
+	unsigned int len;
+	char *copy = NULL;
+	
+	if (strcmp(name, gamedata->leaf) == 0){
+		gamedata->name = gamedata->leaf;
+		return 0;
+	}
+	
+	len = strlen(name);
+	if (len > (MAX_NAME_SIZE - 1)){
+		len = MAX_NAME_SIZE - 1;
+	}
+	if ((gamedata->name != NULL) && (gamedata->name != gamedata->leaf) && (strlen(gamedata->name) >= len)){
+		copy = gamedata->name;
+	} else {
+		copy = (char *) arenaAlloc(len + 1);
+		if (copy == NULL){
+			if (DATA_VERBOSE){
+				printf("%s.%d\t setGameName() Unable to allocate name [%s]\n", __FILE__, __LINE__, name);
+			}
+			return -1;
+		}
+	}
+	memcpy(copy, name, len);
+	copy[len] = '\0';
+	gamedata->name = copy;
+	return 0;
+}
+
+void freeGamedata(){
+	/* Free the whole scan arena; all game records, metadata, keywords and search paths
+	   that came from it become invalid */
+	
+	arena_block_t *block = NULL;
+	
+	while (arena_blocks != NULL){
+		block = arena_blocks->next;
+		free(arena_blocks);
+		arena_blocks = block;
+	}
+	arena_used = 0;
+	arena_wasted = 0;
+	arena_metadata = 0;
+	gamedata_free = NULL;
+	clearGameidIndex();
+	clearMetadata();
+}
+
+int indexGamedata(gamedata_t *gamedata){
+	/* Build the index of gameid to gamedata record for every record after the list head,
+	   so that getGameid() is a direct lookup. Must be called again if records are added
+	   to or removed from the list; sorting it is fine, as the records themselves don't move.
+	   Returns -1, leaving nothing indexed, if any gameid is beyond the end of the index. */
+	
+	int block;
+	
+	clearGameidIndex();
+	
+	gamedata = gamedata->next;
+	while (gamedata != NULL){
+		if (gamedata->gameid >= 0){
+			block = gamedata->gameid / GAMEID_BLOCK;
+			if (block >= GAMEID_BLOCKS){
+				if (DATA_VERBOSE){
+					printf("%s.%d\t indexGamedata() Gameid %d is too large to index\n", __FILE__, __LINE__, gamedata->gameid);
+				}
+				clearGameidIndex();
+				return -1;
+			}
+			if (gameid_index[block] == NULL){
+				gameid_index[block] = (gamedata_t **) calloc(sizeof(gamedata_t *), GAMEID_BLOCK);
+				if (gameid_index[block] == NULL){
+					if (DATA_VERBOSE){
+						printf("%s.%d\t indexGamedata() Unable to allocate gameid index block %d\n", __FILE__, __LINE__, block);
+					}
+					clearGameidIndex();
+					return -1;
+				}
+			}
+			gameid_index[block][gamedata->gameid % GAMEID_BLOCK] = gamedata;
+			if (gamedata->gameid >= gameid_max){
+				gameid_max = gamedata->gameid + 1;
+			}
+		}
+		gamedata = gamedata->next;
+	}
+	if (DATA_VERBOSE){
+		printf("%s.%d\t indexGamedata() Indexed gameids 0-%d\n", __FILE__, __LINE__, gameid_max - 1);
+	}
+	return 0;
+}
 
 gamedata_t * getGameid(int gameid, gamedata_t *gamedata){
 	// Find a given gameid from the list	
 	
+	gamedata_t *found = NULL;
+	
+	// Direct lookup, if the list has been indexed
+	if ((gameid >= 0) && (gameid < gameid_max) && ((gameid / GAMEID_BLOCK) < GAMEID_BLOCKS)){
+		if (gameid_index[gameid / GAMEID_BLOCK] != NULL){
+			found = gameid_index[gameid / GAMEID_BLOCK][gameid % GAMEID_BLOCK];
+			if (found != NULL){
+				return found;
+			}
+		}
+	}
+	
 	while (gamedata != NULL){
 		if (gamedata->gameid == gameid){
 			return gamedata;
@@ -63,325 +445,359 @@ gamedir_t * getLastGameDir(gamedir_t *gamedir){
 }
 
 int removeGamedata(gamedata_t *gamedata){
-	/* Remove all nodes of a given gamedata list */
+	/* Return all nodes of a given gamedata list to the pool of free records */
 	
-	gamedata_t * current = gamedata;
 	gamedata_t * next = NULL;
 	
-	if (current->next == NULL){
+	while (gamedata != NULL){
+		next = gamedata->next;
 		if (DATA_VERBOSE){
-			printf("%s.%d\t removeGamedata() Freeing gamedata single object\n", __FILE__, __LINE__);	
-		}
-		free(current);
-		gamedata = NULL;
-		return 0;
-	}
-	
-	while(current != NULL){
-		if (current->next != NULL){
-			/* There's another element, so free() this one and
-			    then move on to the next */
-			next = current->next;
-			if (DATA_VERBOSE){
-				printf("%s.%d\t removeGamedata() Freeing gamedata list object [%s]\n", __FILE__, __LINE__, current->next->name);	
-			}
-			free(current);
-			current = next;
-		} else {
-			/* There are no more elements linked */
-			free(current);
-			current = NULL;
-			return 0;
+			printf("%s.%d\t removeGamedata() Releasing gamedata list object [%s]\n", __FILE__, __LINE__, gamedata->name);	
 		}
+		gamedata->next = gamedata_free;
+		gamedata_free = gamedata;
+		gamedata = next;
 	}
 	return 0;
 }
 
-int sortGamedata(gamedata_t *gamedata, int verbose){
-	// Sort the list of game data objects by name
-	// This is bubble sort, so it's reasonably slow, but 
-	// simple to implement.
+int compareName(char *a, char *b){
+	/* Compare two game names, ignoring case, so that 'doom' sorts next to 'DOOM II' */
 	
-	int swapped;
-	int compare;
+	int ca, cb;
 	
-	gamedata_t *gdata1 = NULL;
-	gamedata_t *gdata2 = NULL;
+	do {
+		ca = toupper((unsigned char) *a);
+		cb = toupper((unsigned char) *b);
+		a++;
+		b++;
+	} while ((ca == cb) && (ca != '\0'));
+	return ca - cb;
+}
+
+int sortGamedata(gamedata_t *gamedata, int verbose){
+	// Sort the list of game data objects by name, ignoring case
+	// This is a bottom-up merge sort of the list itself. Runs of
+	// 1, 2, 4... records are merged by relinking the next pointers,
+	// so no records are copied and nothing is allocated.
+	
+	unsigned int insize, psize, qsize, i;
+	int merges;
+	gamedata_t *list = NULL;
+	gamedata_t *tail = NULL;
+	gamedata_t *p = NULL;
+	gamedata_t *q = NULL;
+	gamedata_t *e = NULL;
 	
 	/* Nothing more after this point, consider it sorted */
-	if (gamedata->next == NULL){
+	list = gamedata->next;
+	if (list == NULL){
 		return 0;
 	}
 	
+	insize = 1;
 	do {
-		swapped = 0;
-		gdata1 = gamedata;
-		while (gdata1->next != gdata2){
-			compare = strcmp(gdata1->name, gdata1->next->name);
-			if (compare > 0){
-				/* swap objects */
-				swapGamedata(gdata1, gdata1->next);
-				swapped = 1;
+		p = list;
+		list = NULL;
+		tail = NULL;
+		merges = 0;
+		while (p != NULL){
+			merges++;
+			
+			/* q starts insize records after p */
+			q = p;
+			psize = 0;
+			for (i = 0; i < insize; i++){
+				psize++;
+				q = q->next;
+				if (q == NULL){
+					break;
+				}
 			}
-			gdata1 = gdata1->next;
+			qsize = insize;
+			
+			/* merge the run at p with the run at q, taking from p on a tie to keep the sort stable */
+			while ((psize > 0) || ((qsize > 0) && (q != NULL))){
+				if (psize == 0){
+					e = q;
+					q = q->next;
+					qsize--;
+				} else if ((qsize == 0) || (q == NULL)){
+					e = p;
+					p = p->next;
+					psize--;
+				} else if (compareName(p->name, q->name) <= 0){
+					e = p;
+					p = p->next;
+					psize--;
+				} else {
+					e = q;
+					q = q->next;
+					qsize--;
+				}
+				if (tail != NULL){
+					tail->next = e;
+				} else {
+					list = e;
+				}
+				tail = e;
+			}
+			p = q;
 		}
-		gdata2 = gdata1;
+		tail->next = NULL;
+		insize = insize * 2;
 	}
-	while (swapped);
-	return 0;
-}
-
-int swapGamedata(gamedata_t *gamedata1, gamedata_t *gamedata2){
-	/* swap one game object with another */
-	
-	gamedata_t *gdata_temp = NULL;
-	gdata_temp = (gamedata_t *) malloc(sizeof(gamedata_t));
-	
-	/* keep temp store of gamedata1 */
-	gdata_temp->gameid = gamedata1->gameid;
-	gdata_temp->drive = gamedata1->drive;
-	strcpy(gdata_temp->path, gamedata1->path);
-	strcpy(gdata_temp->name, gamedata1->name);
-	gdata_temp->has_dat = gamedata1->has_dat;
-	
-	/* swap a with b */
-	gamedata1->gameid = gamedata2->gameid;
-	gamedata1->drive = gamedata2->drive;
-	strcpy(gamedata1->path, gamedata2->path);
-	strcpy(gamedata1->name, gamedata2->name);
-	gamedata1->has_dat = gamedata2->has_dat;
+	while (merges > 1);
 	
-	/* swap b with temp */
-	gamedata2->gameid = gdata_temp->gameid;
-	gamedata2->drive = gdata_temp->drive;
-	strcpy(gamedata2->path, gdata_temp->path);
-	strcpy(gamedata2->name, gdata_temp->name);
-	gamedata2->has_dat = gdata_temp->has_dat;
-	
-	/* Free up temp store */
-	free(gdata_temp);
+	gamedata->next = list;
 	return 0;
 }
 
-static int launchdatHandler(void* user, const char* section, const char* name, const char* value){
+// What to do with the value of each launch.dat key
+#define LAUNCHDAT_STRING		0		// Copy into a string field of launchdat_t
+#define LAUNCHDAT_INT		1		// Convert into an int field of launchdat_t
+#define LAUNCHDAT_FLAG		2		// Set an int field of launchdat_t if the value is 1
+#define LAUNCHDAT_HW			3		// Set a hardware capability bit if the value is 1
+
+// Every launch.dat key, sorted by section and then by name, exactly as strcmp() orders
+// them, so that launchdatHandler() can binary search for a key.
+static struct {
+	char *section;
+	char *name;
+	unsigned char type;					// LAUNCHDAT_*
+	unsigned short offset;				// Offset of the field in launchdat_t
+	unsigned short size;					// Size of a string field
+	hwdata_t mask;						// Capability bit of a hardware key
+} launchdat_keys[] = {
+	{ "cpu",		"286",			LAUNCHDAT_HW,		0, 0,	HW_CPU_286 },
+	{ "cpu",		"386",			LAUNCHDAT_HW,		0, 0,	HW_CPU_386 },
+	{ "cpu",		"486",			LAUNCHDAT_HW,		0, 0,	HW_CPU_486 },
+	{ "cpu",		"586",			LAUNCHDAT_HW,		0, 0,	HW_CPU_586 },
+	{ "cpu",		"8086",			LAUNCHDAT_HW,		0, 0,	HW_CPU_8086 },
+	{ "cpu",		"dpmi",			LAUNCHDAT_HW,		0, 0,	HW_DPMI },
+	{ "cpu",		"ems",			LAUNCHDAT_HW,		0, 0,	HW_RAM_EMS },
+	{ "cpu",		"xms",			LAUNCHDAT_HW,		0, 0,	HW_RAM_XMS },
+	{ "default",	"alt_start",		LAUNCHDAT_STRING,	offsetof(launchdat_t, alt_start),	MAX_FILENAME_SIZE,	0 },
+	{ "default",	"developer",		LAUNCHDAT_STRING,	offsetof(launchdat_t, developer),	MAX_STRING_SIZE,	0 },
+	{ "default",	"genre",			LAUNCHDAT_STRING,	offsetof(launchdat_t, genre),		MAX_STRING_SIZE,	0 },
+	{ "default",	"images",		LAUNCHDAT_STRING,	offsetof(launchdat_t, images),		IMAGE_BUFFER_SIZE,	0 },
+	{ "default",	"midi_mpu",		LAUNCHDAT_FLAG,		offsetof(launchdat_t, midi),		0,	0 },
+	{ "default",	"midi_serial",	LAUNCHDAT_FLAG,		offsetof(launchdat_t, midi_serial),	0,	0 },
+	{ "default",	"name",			LAUNCHDAT_STRING,	offsetof(launchdat_t, realname),	MAX_NAME_SIZE,		0 },
+	{ "default",	"publisher",		LAUNCHDAT_STRING,	offsetof(launchdat_t, publisher),	MAX_STRING_SIZE,	0 },
+	{ "default",	"series",		LAUNCHDAT_STRING,	offsetof(launchdat_t, series),		MAX_STRING_SIZE,	0 },
+	{ "default",	"start",			LAUNCHDAT_STRING,	offsetof(launchdat_t, start),		MAX_FILENAME_SIZE,	0 },
+	{ "default",	"year",			LAUNCHDAT_INT,		offsetof(launchdat_t, year),		0,	0 },
+	{ "sound",	"adlib",			LAUNCHDAT_HW,		0, 0,	HW_ADLIB },
+	{ "sound",	"beeper",		LAUNCHDAT_HW,		0, 0,	HW_BEEPER },
+	{ "sound",	"covox",			LAUNCHDAT_HW,		0, 0,	HW_COVOX },
+	{ "sound",	"disney",		LAUNCHDAT_HW,		0, 0,	HW_DISNEY },
+	{ "sound",	"gm",			LAUNCHDAT_HW,		0, 0,	HW_GM },
+	{ "sound",	"mt32",			LAUNCHDAT_HW,		0, 0,	HW_MT32 },
+	{ "sound",	"soundblaster",	LAUNCHDAT_HW,		0, 0,	HW_SOUNDBLASTER },
+	{ "sound",	"tandy",			LAUNCHDAT_HW,		0, 0,	HW_TANDY_AUDIO },
+	{ "sound",	"ultrasound",	LAUNCHDAT_HW,		0, 0,	HW_ULTRASOUND },
+	{ "video",	"cga",			LAUNCHDAT_HW,		0, 0,	HW_CGA },
+	{ "video",	"ega",			LAUNCHDAT_HW,		0, 0,	HW_EGA },
+	{ "video",	"hercules",		LAUNCHDAT_HW,		0, 0,	HW_HERCULES },
+	{ "video",	"svga",			LAUNCHDAT_HW,		0, 0,	HW_SVGA },
+	{ "video",	"tandy",			LAUNCHDAT_HW,		0, 0,	HW_TANDY_VIDEO },
+	{ "video",	"text",			LAUNCHDAT_HW,		0, 0,	HW_TEXT },
+	{ "video",	"vga",			LAUNCHDAT_HW,		0, 0,	HW_VGA },
+};
+#define LAUNCHDAT_KEYS (sizeof(launchdat_keys) / sizeof(launchdat_keys[0]))
+
+int launchdatHandler(void* user, const char* section, const char* name, const char* value){
 	/* Based on reference implementation of inih parser:
 	    https://github.com/benhoyt/inih
 	    */
-	    
+	
 	launchdat_t* launchdat = (launchdat_t*)user;
-		
-	#define MATCH(s, n) strcmp(section, s) == 0 && strcmp(name, n) == 0
-	if (MATCH("default", "name")){
-		strncpy(launchdat->realname, value, MAX_NAME_SIZE);
-		
-	} else if (MATCH("default", "genre")){
-		strncpy(launchdat->genre, value, MAX_STRING_SIZE);
-		
-	} else if (MATCH("default", "developer")){
-		strncpy(launchdat->developer, value, MAX_STRING_SIZE);
-		
-	} else if (MATCH("default", "publisher")){
-		strncpy(launchdat->publisher, value, MAX_STRING_SIZE);
-		
-	} else if (MATCH("default", "year")){
-		launchdat->year = atoi(value);
-		
-	} else if (MATCH("default", "midi_mpu")){
-		if (atoi(value) == 1){
-			launchdat->midi = 1;
-		}
-	} else if (MATCH("default", "midi_serial")){
-		if (atoi(value) == 1){
-			launchdat->midi_serial = 1;
-		}
-	} else if (MATCH("default", "start")){
-		strncpy(launchdat->start, value, MAX_FILENAME_SIZE);
+	char *field;
+	int low;
+	int high;
+	int mid;
+	int c;
 	
-	} else if (MATCH("default", "alt_start")){
-		strncpy(launchdat->alt_start, value, MAX_FILENAME_SIZE);
-		
-	} else if (MATCH("default", "images")){
-		strncpy(launchdat->images, value, IMAGE_BUFFER_SIZE);
-		
-	} else if (MATCH("default", "series")){
-		strncpy(launchdat->series, value, MAX_STRING_SIZE);
-	// audio hardware metadata 
-	} else if (MATCH("sound", "beeper")){
-		if (atoi(value) == 1){
-			launchdat->hardware->beeper = 1;
-		}
-	} else if (MATCH("sound", "tandy")){
-		if (atoi(value) == 1){
-			launchdat->hardware->tandy_audio = 1;
-		}
-	} else if (MATCH("sound", "adlib")){
-		if (atoi(value) == 1){
-			launchdat->hardware->adlib = 1;
+	// Binary search of the key table; section first, then name
+	low = 0;
+	high = LAUNCHDAT_KEYS - 1;
+	while (low <= high){
+		mid = (low + high) / 2;
+		c = strcmp(section, launchdat_keys[mid].section);
+		if (c == 0){
+			c = strcmp(name, launchdat_keys[mid].name);
 		}
-	} else if (MATCH("sound", "soundblaster")){
-		if (atoi(value) == 1){
-			launchdat->hardware->soundblaster = 1;
-		}
-	} else if (MATCH("sound", "mt32")){
-		if (atoi(value) == 1){
-			launchdat->hardware->mt32 = 1;
-		}
-	} else if (MATCH("sound", "gm")){
-		if (atoi(value) == 1){
-			launchdat->hardware->gm = 1;
-		}
-	} else if (MATCH("sound", "covox")){
-		if (atoi(value) == 1){
-			launchdat->hardware->covox = 1;
-		}
-	} else if (MATCH("sound", "disney")){
-		if (atoi(value) == 1){
-			launchdat->hardware->disney = 1;
-		}
-	} else if (MATCH("sound", "ultrasound")){
-		if (atoi(value) == 1){
-			launchdat->hardware->ultrasound = 1;
-		}
-	// video hardware metadata
-	} else if (MATCH("video", "text")){
-		if (atoi(value) == 1){
-			launchdat->hardware->text = 1;
-		}
-	} else if (MATCH("video", "hercules")){
-		if (atoi(value) == 1){
-			launchdat->hardware->hercules = 1;
-		}
-	} else if (MATCH("video", "tandy")){
-		if (atoi(value) == 1){
-			launchdat->hardware->tandy_video = 1;
-		}
-	} else if (MATCH("video", "cga")){
-		if (atoi(value) == 1){
-			launchdat->hardware->cga = 1;
-		}
-	} else if (MATCH("video", "ega")){
-		if (atoi(value) == 1){
-			launchdat->hardware->ega = 1;
-		}
-	} else if (MATCH("video", "vga")){
-		if (atoi(value) == 1){
-			launchdat->hardware->vga = 1;
-		}
-	} else if (MATCH("video", "svga")){
-		if (atoi(value) == 1){
-			launchdat->hardware->svga = 1;
-		}	
-	// cpu/misc hardware metadata
-	} else if (MATCH("cpu", "8086")){
-		if (atoi(value) == 1){
-			launchdat->hardware->cpu_8086 = 1;
-		}
-	} else if (MATCH("cpu", "286")){
-		if (atoi(value) == 1){
-			launchdat->hardware->cpu_286 = 1;
-		}
-	} else if (MATCH("cpu", "386")){
-		if (atoi(value) == 1){
-			launchdat->hardware->cpu_386 = 1;
-		}
-	} else if (MATCH("cpu", "486")){
-		if (atoi(value) == 1){
-			launchdat->hardware->cpu_486 = 1;
-		}
-	} else if (MATCH("cpu", "586")){
-		if (atoi(value) == 1){
-			launchdat->hardware->cpu_586 = 1;
-		}
-	} else if (MATCH("cpu", "xms")){
-		if (atoi(value) == 1){
-			launchdat->hardware->ram_xms = 1;
-		}
-	} else if (MATCH("cpu", "ems")){
-		if (atoi(value) == 1){
-			launchdat->hardware->ram_ems = 1;
-		}
-	} else if (MATCH("cpu", "dpmi")){
-		if (atoi(value) == 1){
-			launchdat->hardware->dpmi = 1;
+		if (c < 0){
+			high = mid - 1;
+		} else if (c > 0){
+			low = mid + 1;
+		} else {
+			field = (char *) launchdat + launchdat_keys[mid].offset;
+			switch(launchdat_keys[mid].type){
+				case(LAUNCHDAT_STRING):
+					strncpy(field, value, launchdat_keys[mid].size);
+					break;
+				case(LAUNCHDAT_INT):
+					*((int *) field) = atoi(value);
+					break;
+				case(LAUNCHDAT_FLAG):
+					if (atoi(value) == 1){
+						*((int *) field) = 1;
+					}
+					break;
+				case(LAUNCHDAT_HW):
+					if (atoi(value) == 1){
+						launchdat->hardware |= launchdat_keys[mid].mask;
+					}
+					break;
+			}
+			return 1;
 		}
-	} else {
-		return 0;  /* unknown section/name, error */
 	}
-	return 1;
+	return 0;  /* unknown section/name, error */
 }
 
 void launchdataDefaults(launchdat_t *launchdat){
 	/* Set some defaults, in case various lines arent there */
 	
-	memset(launchdat->realname, '\0', strlen(launchdat->realname));
-	memset(launchdat->genre, '\0', strlen(launchdat->genre));
-	memset(launchdat->publisher, '\0', strlen(launchdat->publisher));
-	memset(launchdat->developer, '\0', strlen(launchdat->developer));
-	memset(launchdat->start, '\0', strlen(launchdat->start));
-	memset(launchdat->alt_start, '\0', strlen(launchdat->alt_start));
-	memset(launchdat->images, '\0', strlen(launchdat->images));
-	memset(launchdat->series, '\0', strlen(launchdat->series));
+	memset(launchdat->realname, '\0', sizeof(launchdat->realname));
+	memset(launchdat->genre, '\0', sizeof(launchdat->genre));
+	memset(launchdat->publisher, '\0', sizeof(launchdat->publisher));
+	memset(launchdat->developer, '\0', sizeof(launchdat->developer));
+	memset(launchdat->start, '\0', sizeof(launchdat->start));
+	memset(launchdat->alt_start, '\0', sizeof(launchdat->alt_start));
+	memset(launchdat->images, '\0', sizeof(launchdat->images));
+	memset(launchdat->series, '\0', sizeof(launchdat->series));
 	launchdat->year = DEFAULT_YEAR;
 	launchdat->midi = 0;
 	launchdat->midi_serial = 0;
 	
-	// Audio defaults
-	launchdat->hardware->beeper = 0;
-	launchdat->hardware->tandy_audio = 0;
-	launchdat->hardware->adlib = 0;
-	launchdat->hardware->soundblaster = 0;
-	launchdat->hardware->mt32 = 0;
-	launchdat->hardware->gm = 0;
-	launchdat->hardware->covox = 0;
-	launchdat->hardware->disney = 0;
-	launchdat->hardware->ultrasound = 0;
-	
-	// Video defaults
-	launchdat->hardware->text = 0;
-	launchdat->hardware->hercules = 0;
-	launchdat->hardware->tandy_video = 0;
-	launchdat->hardware->cga = 0;
-	launchdat->hardware->ega = 0;
-	launchdat->hardware->vga = 0;
-	launchdat->hardware->svga = 0;
-	
-	// CPU/misc defaults
-	launchdat->hardware->cpu_8086 = 0;
-	launchdat->hardware->cpu_286 = 0;
-	launchdat->hardware->cpu_386 = 0;
-	launchdat->hardware->cpu_486 = 0;
-	launchdat->hardware->cpu_586 = 0;
-	launchdat->hardware->ram_xms = 0;
-	launchdat->hardware->ram_ems = 0;
-	launchdat->hardware->dpmi = 0;
+	// No audio, video or cpu/misc hardware unless listed
+	launchdat->hardware = 0;
 }
 
 void configDefaults(config_t *config){
 	/* Set some defaults, in case various lines arent there */
 	
 	config->verbose = 0;
-	memset(config->dirs, '\0', strlen(config->dirs));
+	memset(config->dirs, '\0', sizeof(config->dirs));
 	config->save = 0;
 	config->preload_names = 0;
 	config->dir = NULL;
 	config->keyboard_test = 0;
+	config->rescan = 0;
+}
+
+static char launchdat_buffer[GAMEDAT_BUFFER_SIZE + 1];	// Holds the whole of a launch.dat while it is parsed
+
+static long readLaunchdat(char *filepath){
+	/* Read the whole of a launch.dat into the buffer with a single read. Returns its
+	   length, GAMEDAT_BUFFER_SIZE if it was too big to fit, or -1 if it can't be opened. */
+	
+	FILE *file;
+	size_t len;
+	
+	file = platform_Open(filepath, "rb");
+	if (file == NULL){
+		return -1;
+	}
+	// Read straight into our own buffer, rather than through the stream buffer
+	setvbuf(file, NULL, _IONBF, 0);
+	len = fread(launchdat_buffer, 1, GAMEDAT_BUFFER_SIZE, file);
+	fclose(file);
+	
+	if (len >= GAMEDAT_BUFFER_SIZE){
+		if (DATA_VERBOSE){
+			printf("%s.%d\t readLaunchdat() %s is too big to read in one go\n", __FILE__, __LINE__, filepath);
+		}
+		return GAMEDAT_BUFFER_SIZE;
+	}
+	launchdat_buffer[len] = '\0';
+	return (long) len;
+}
+
+static int parseIni(char *filepath, ini_handler handler, void *user){
+	/* Parse an ini file line by line, opening it through the platform layer. Returns
+	   -1 if it can't be opened, otherwise the same as ini_parse_file(). */
+	
+	FILE *file;
+	int status;
+	
+	file = platform_Open(filepath, "r");
+	if (file == NULL){
+		return -1;
+	}
+	status = ini_parse_file(file, handler, user);
+	fclose(file);
+	return status;
+}
+
+static int parseLaunchdat(char *filepath, ini_handler handler, void *user){
+	/* Parse a launch.dat from memory, after reading all of it with a single read.
+	   Anything too big for the buffer is parsed line by line from the file instead. */
+	
+	long len;
+	
+	len = readLaunchdat(filepath);
+	if (len < 0){
+		return -1;
+	}
+	if (len >= GAMEDAT_BUFFER_SIZE){
+		return parseIni(filepath, handler, user);
+	}
+	return ini_parse_string(launchdat_buffer, handler, user);
+}
+
+static char * launchdatNameReader(char *str, int num, void *stream){
+	/* Line reader for a name-only parse of the buffer; runs out of lines as soon as the name is found */
+	
+	launchdat_name_t *probe = (launchdat_name_t *) stream;
+	char *end = str;
+	
+	if ((probe->found) || (*probe->ptr == '\0')){
+		return NULL;
+	}
+	while ((num > 1) && (*probe->ptr != '\0')){
+		*end = *probe->ptr;
+		end++;
+		num--;
+		if (*probe->ptr++ == '\n'){
+			break;
+		}
+	}
+	*end = '\0';
+	return str;
+}
+
+static int launchdatNameHandler(void* user, const char* section, const char* name, const char* value){
+	/* Pick out just the [default] name key, ignoring everything else */
+	
+	launchdat_name_t *probe = (launchdat_name_t *) user;
+	
+	if ((strcmp(section, "default") == 0) && (strcmp(name, "name") == 0)){
+		strncpy(probe->name, value, MAX_NAME_SIZE - 1);
+		probe->name[MAX_NAME_SIZE - 1] = '\0';
+		probe->found = 1;
+	}
+	return 1;
 }
 
 int getLaunchdata(gamedata_t *gamedata, launchdat_t *launchdat){
 	/* load and return a launch.dat from from disk, for a given gamedata object */
 	
-	char filepath[MAX_PATH_SIZE];
+	char filepath[MAX_GAMEPATH_SIZE + MAX_FILENAME_SIZE];
 	
 	if (gamedata->has_dat != 1){
 		return -1;
 	}
 	
-	strcpy(filepath, gamedata->path);
+	getGamePath(gamedata, filepath);
 	strcat(filepath, "\\");
 	strcat(filepath, GAMEDAT);
 	
 	launchdataDefaults(launchdat);
-	if (ini_parse(filepath, launchdatHandler, launchdat) < 0) {
+	if (parseLaunchdat(filepath, launchdatHandler, launchdat) < 0) {
 		if (DATA_VERBOSE){
 			printf("%s.%d\t getLaunchdata() Cannot load %s\n", __FILE__, __LINE__, filepath);
 		}
@@ -394,6 +810,95 @@ int getLaunchdata(gamedata_t *gamedata, launchdat_t *launchdat){
 	}
 }
 
+int getLaunchdataName(gamedata_t *gamedata, char *name){
+	/* Read just the real name from the launch.dat of a gamedata object. Parsing stops
+	   as soon as the name has been seen, and no other metadata is touched. The name
+	   is left as it is if the file doesn't have one. */
+	
+	char filepath[MAX_GAMEPATH_SIZE + MAX_FILENAME_SIZE];
+	long len;
+	launchdat_name_t probe;
+	
+	if (gamedata->has_dat != 1){
+		return -1;
+	}
+	
+	getGamePath(gamedata, filepath);
+	strcat(filepath, "\\");
+	strcat(filepath, GAMEDAT);
+	
+	probe.ptr = launchdat_buffer;
+	probe.name = name;
+	probe.found = 0;
+	
+	len = readLaunchdat(filepath);
+	if (len < 0){
+		if (DATA_VERBOSE){
+			printf("%s.%d\t getLaunchdataName() Cannot load %s\n", __FILE__, __LINE__, filepath);
+		}
+		return -1;
+	}
+	if (len >= GAMEDAT_BUFFER_SIZE){
+		parseIni(filepath, launchdatNameHandler, &probe);
+	} else {
+		ini_parse_stream((ini_reader) launchdatNameReader, &probe, launchdatNameHandler, &probe);
+	}
+	if (DATA_VERBOSE){
+		printf("%s.%d\t getLaunchdataName() Loaded %s, name %s\n", __FILE__, __LINE__, filepath, probe.found ? name : "not set");
+	}
+	return 0;
+}
+
+metadata_t * getMetadata(gamedata_t *gamedata, launchdat_t *launchdat){
+	/* Return the filter metadata of a game, loading it from launch.dat the first time only.
+	   Returns NULL if it couldn't be loaded, which is also only tried the first time. */
+	
+	// gamedata: The game to return metadata for
+	// launchdat: Scratch launchdat object used to load the file, its contents are overwritten
+	
+	int status;
+	metadata_t found;
+	metadata_t *meta = NULL;
+	
+	if (gamedata->meta == &metadata_none){
+		return NULL;
+	}
+	if (gamedata->meta != NULL){
+		return gamedata->meta;
+	}
+	
+	// Anything that fails from here on would fail again, so the game is marked as
+	// having no metadata rather than reading its launch.dat on every filter pass
+	gamedata->meta = &metadata_none;
+	status = getLaunchdata(gamedata, launchdat);
+	if (status != 0){
+		return NULL;
+	}
+	
+	found.genre = addKeyword(launchdat->genre, MAX_STRING_SIZE);
+	found.series = addKeyword(launchdat->series, MAX_STRING_SIZE);
+	found.publisher = addKeyword(launchdat->publisher, MAX_STRING_SIZE);
+	found.developer = addKeyword(launchdat->developer, MAX_STRING_SIZE);
+	if ((found.genre == KEYWORD_NONE) || (found.series == KEYWORD_NONE) || (found.publisher == KEYWORD_NONE) || (found.developer == KEYWORD_NONE)){
+		return NULL;
+	}
+	found.year = launchdat->year;
+	found.hardware = launchdat->hardware;
+	
+	// Only kept once it is complete, as nothing in the scan arena can be handed back
+	meta = (metadata_t *) arenaAlloc(sizeof(metadata_t));
+	if (meta == NULL){
+		if (DATA_VERBOSE){
+			printf("%s.%d\t getMetadata() Unable to allocate a new metadata record\n", __FILE__, __LINE__);
+		}
+		return NULL;
+	}
+	memcpy(meta, &found, sizeof(metadata_t));
+	arena_metadata += sizeof(metadata_t);
+	gamedata->meta = meta;
+	return meta;
+}
+
 static int configHandler(void* user, const char* section, const char* name, const char* value){
 	/* Based on reference implementation of inih parser:
 	    https://github.com/benhoyt/inih
@@ -414,6 +919,8 @@ static int configHandler(void* user, const char* section, const char* name, cons
 		config->keyboard_test =  atoi(value);
 	} else if (MATCH("default", "timers")){
 		config->timers =  atoi(value);
+	} else if (MATCH("default", "rescan")){
+		config->rescan =  atoi(value);
 	} else {
 		return 0;  /* unknown section/name, error */
 	}
@@ -435,7 +942,7 @@ int getIni(config_t *config, int verbose){
 	memset(my_dir, '\0', sizeof(my_dir));
 	memset(my_path, '\0', sizeof(my_path));
 	
-	getcwd(my_dir, DIR_BUFFER_SIZE);
+	platform_GetDir(my_dir, DIR_BUFFER_SIZE);
 	my_drive = drvLetterFromPath(my_dir);
 	status = dirFromPath(my_dir, my_path);
 	
@@ -450,12 +957,12 @@ int getIni(config_t *config, int verbose){
 	configDefaults(config);
 	
 	// Back to original dir
-	chdir(my_dir);
+	platform_ChangeDir(my_dir);
 	
 	if (DATA_VERBOSE){
 		printf("%s.%d\t getIni() Calling parser\n", __FILE__, __LINE__);
 	}
-	if (ini_parse(my_path, configHandler, config) < 0) {
+	if (parseIni(my_path, configHandler, config) < 0) {
 		if (DATA_VERBOSE){
 			printf("%s.%d\t getIni() Cannot load %s\n", __FILE__, __LINE__, my_path);
 		}
@@ -481,7 +988,7 @@ int getImageList(launchdat_t *launchdat, imagefile_t *imagefile){
 	
 	// Reset the imagefile list array
 	for(found =0; found < MAX_IMAGES; found++){
-		memset(imagefile->filename[found], '\0', MAX_STRING_SIZE);
+		memset(imagefile->filename[found], '\0', MAX_FILENAME_SIZE);
 	}
 	found = 0;
 	imagefile->selected = -1;
@@ -530,6 +1037,9 @@ int getDirList(config_t *config, gamedir_t *gamedir, int verbose){
 	int found;	// Counter for number of found game search directories
 	found = 0;
 	
+	// Search paths are always added at the end of the list
+	gamedir = getLastGameDir(gamedir);
+	
 	if (config->dirs != NULL){
 		strcpy(buffer, config->dirs);
 		p = strtok(buffer, ",");
@@ -539,8 +1049,13 @@ int getDirList(config_t *config, gamedir_t *gamedir, int verbose){
 					printf("%s.%d\t getDirList() Game search path %s\n", __FILE__, __LINE__, p);	
 				}
 				found++;
-				gamedir = getLastGameDir(gamedir);
-				gamedir->next = (gamedir_t *) malloc(sizeof(gamedir_t));
+				gamedir->next = (gamedir_t *) arenaAlloc(sizeof(gamedir_t));
+				if (gamedir->next == NULL){
+					if (DATA_VERBOSE){
+						printf("%s.%d\t getDirList() Unable to allocate game search path %s\n", __FILE__, __LINE__, p);
+					}
+					break;
+				}
 				strcpy(gamedir->next->path, p);
 				gamedir->next->next = NULL;
 				
@@ -548,6 +1063,7 @@ int getDirList(config_t *config, gamedir_t *gamedir, int verbose){
 				if (found == 1){
 					config->dir = gamedir;	
 				}
+				gamedir = gamedir->next;
 				if (found >= MAX_DIRS){
 					if (DATA_VERBOSE){
 						printf("%s.%d\t getDirList() Hit game search path limit [%d]\n", __FILE__, __LINE__, MAX_IMAGES);	
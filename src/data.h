@@ -16,8 +16,10 @@
 */
 
 #define SAVEFILE				"launcher.txt"		// A text file holding the list of all found directories
+#define INDEXFILE			"launcher.idx"		// A binary index of all scraped games, reloaded at start instead of rescanning
 #define INIFILE				"launcher.ini"		// the ini file holding settings for the main application
 #define GAMEDAT				"launch.dat"			// the name of the data file in the game dir to load
+#define GAMEDAT_BUFFER_SIZE	2048				// launch.dat files up to this size are read in a single block
 #define RUNBAT				"run.bat"			// the name of the batch file which will contain the path to the chosen game exe
 #define DEFAULT_GENRE		"Unknown Genre"		// Default genre
 #define DEFAULT_YEAR 		0					// Default year
@@ -33,46 +35,89 @@
 #define MAX_SEARCHDIRS_SIZE	1024
 #define DATA_VERBOSE			0
 #define MAX_PATH_SIZE		65
+#define MAX_GAMEPATH_SIZE	(MAX_PATH_SIZE + MAX_FILENAME_SIZE)	// A search path, a backslash and a game directory name
+#define MAX_IMAGEPATH_SIZE	(MAX_GAMEPATH_SIZE + MAX_FILENAME_SIZE)	// A game path, a backslash and an artwork filename
+#define ARENA_BLOCK			8192					// Bytes in each block of the scan arena
+#define ARENA_ALIGN			sizeof(void *)		// Every allocation from the scan arena starts on a multiple of this
+#define GAMEID_BLOCK			1024					// Number of entries in each block of the gameid index
+#define GAMEID_BLOCKS		32					// Number of blocks in the gameid index; gameids 0-32767, which is every positive 16 bit int
+#define KEYWORD_HASH			256					// Number of hash buckets in the keyword dictionary
+#define KEYWORD_BLOCK		256					// Number of keyword ids the dictionary grows by at once
+#define KEYWORD_MAX			16000				// Maximum number of keyword ids, so the id table stays within a segment
+#define KEYWORD_NONE			0xFFFF				// Id returned for a keyword that isn't in the dictionary
 
-// A linked list of the games which we have scraped
+// A list of game directories to search and scrape at run time.
+typedef struct gamedir {
+	char path[MAX_PATH_SIZE];			// Path to search for games
+	unsigned short date;				// DOS date stamp of the search path directory entry
+	unsigned short time;				// DOS time stamp of the search path directory entry
+	unsigned short entries;			// Number of entries found in the search path when it was last enumerated
+	struct gamedir *next;				// Link to the next search path
+} gamedir_t;
+
+// A linked list of the games which we have scraped. The full path of a game is never
+// stored, as the search path part of it is the same for every game under that search
+// path; getGamePath() puts it together from dir and leaf whenever it is needed.
 typedef struct gamedata {
 	int gameid;					// Unique ID for this game - assigned at scan time
-	char drive;					// Drive letter
-	char path[MAX_PATH_SIZE];	// Full drive and path name; e.g. A:\Games\FinalFight
-	char name[MAX_NAME_SIZE];	// Just the directory name; e.g. FinalFight
-	int has_dat;					// Flag to indicate __launch.dat was found in the game directory
+	char leaf[MAX_FILENAME_SIZE];	// Just the directory name, under the search path in dir; e.g. FINALFGT
+	char *name;					// Name to show; points at leaf until a real name is set by setGameName()
+	unsigned char has_dat;		// Flag to indicate __launch.dat was found in the game directory
+	unsigned char has_name;		// Whether name holds the real name yet; see NAMES_PENDING in names.h
+	unsigned short date;			// DOS date stamp of the game directory entry
+	unsigned short time;			// DOS time stamp of the game directory entry
+	unsigned long dat_size;		// Size of launch.dat, or 0 if there isn't one
+	unsigned short dat_date;		// DOS date stamp of launch.dat; adding or editing it doesn't change the directory stamp on FAT
+	unsigned short dat_time;		// DOS time stamp of launch.dat
+	struct gamedir *dir;			// The search path this game was found under
+	struct metadata *meta;		// Filter metadata from launch.dat, loaded on first use by getMetadata()
 	struct gamedata *next;		// Pointer to next gamedata entry
 } gamedata_t;
 
-// Hardware metadata for a game
-typedef struct hwdata {
-	unsigned char beeper;				// Game supports PC speaker
-	unsigned char tandy_audio;			// Tandy 3-voice
-	unsigned char adlib;					// Adlib FM or compatibles
-	unsigned char soundblaster;			// Soundblaster, or equivalent FM + Digital effects
-	unsigned char mt32;					// MT-32, LAPC or other LA-synthesis modules
-	unsigned char gm;					// General MIDI
-	unsigned char covox;					// Covox Speech Thing
-	unsigned char disney;				// Disney Sound Source
-	unsigned char ultrasound;			// Disney Sound Source
-	
-	unsigned char text;					// Game supports text mode
-	unsigned char hercules;				// Hi-resolution Hercules text mode
-	unsigned char tandy_video;			// Tandy colour graphics	
-	unsigned char cga;					// CGA 4 colour graphics
-	unsigned char ega;					// EGA 16 colour graphics
-	unsigned char vga;					// VGA 16 or 256 colour graphics at up to 320x240, or 16 colour at 640x480
-	unsigned char svga;					// VGA 256 colour graphics at 640x400 and upwards
-	
-	unsigned char cpu_8086;				// Can run on IBM XT or 8086
-	unsigned char cpu_286;				// Can run on IBM AT or 286 processors
-	unsigned char cpu_386;				// Can run on 386 or better	
-	unsigned char cpu_486;				// Can run on 486 or better
-	unsigned char cpu_586;				// Can run on 586 or better
-	unsigned char ram_xms;				// Uses XMS memory
-	unsigned char ram_ems;				// Uses EMS memory
-	unsigned char dpmi;					// Uses 32bit protected mode
-} hwdata_t;
+// A block of the scan arena. Game records, their metadata, keywords and search paths are
+// all carved out of these by arenaAlloc(), and freed together by freeGamedata().
+typedef struct arena_block {
+	struct arena_block *next;			// The block allocated before this one
+	unsigned int size;					// Bytes of space following this header
+	unsigned int used;					// Bytes of that space handed out so far
+} arena_block_t;
+
+// How the space in the scan arena is being used, as returned by getArenaStats()
+typedef struct arena_stats {
+	unsigned int blocks;					// Number of blocks allocated
+	unsigned long size;					// Bytes of space in all blocks, not counting their headers
+	unsigned long used;					// Bytes asked for and handed out
+	unsigned long wasted;				// Bytes lost to alignment, and left unused at the end of full blocks
+	unsigned long spare;					// Bytes still free at the end of the newest block
+	unsigned long recycled;				// Bytes of game records given back by removeGamedata(), waiting to be reused
+} arena_stats_t;
+
+// Hardware metadata for a game, as a mask of the capability bits below
+#define HW_BEEPER			0x00000001L	// Game supports PC speaker
+#define HW_TANDY_AUDIO		0x00000002L	// Tandy 3-voice
+#define HW_ADLIB			0x00000004L	// Adlib FM or compatibles
+#define HW_SOUNDBLASTER		0x00000008L	// Soundblaster, or equivalent FM + Digital effects
+#define HW_MT32				0x00000010L	// MT-32, LAPC or other LA-synthesis modules
+#define HW_GM				0x00000020L	// General MIDI
+#define HW_COVOX			0x00000040L	// Covox Speech Thing
+#define HW_DISNEY			0x00000080L	// Disney Sound Source
+#define HW_ULTRASOUND		0x00000100L	// Gravis Ultrasound
+#define HW_TEXT				0x00000200L	// Game supports text mode
+#define HW_HERCULES			0x00000400L	// Hi-resolution Hercules text mode
+#define HW_TANDY_VIDEO		0x00000800L	// Tandy colour graphics
+#define HW_CGA				0x00001000L	// CGA 4 colour graphics
+#define HW_EGA				0x00002000L	// EGA 16 colour graphics
+#define HW_VGA				0x00004000L	// VGA 16 or 256 colour graphics at up to 320x240, or 16 colour at 640x480
+#define HW_SVGA				0x00008000L	// VGA 256 colour graphics at 640x400 and upwards
+#define HW_CPU_8086			0x00010000L	// Can run on IBM XT or 8086
+#define HW_CPU_286			0x00020000L	// Can run on IBM AT or 286 processors
+#define HW_CPU_386			0x00040000L	// Can run on 386 or better
+#define HW_CPU_486			0x00080000L	// Can run on 486 or better
+#define HW_CPU_586			0x00100000L	// Can run on 586 or better
+#define HW_RAM_XMS			0x00200000L	// Uses XMS memory
+#define HW_RAM_EMS			0x00400000L	// Uses EMS memory
+#define HW_DPMI				0x00800000L	// Uses 32bit protected mode
+typedef unsigned long hwdata_t;
 
 // A launchdat object is loaded for the parsed launch.dat file included with a game.
 // Only the currently selected game has this object loaded.
@@ -88,9 +133,34 @@ typedef struct launchdat {
 	char start[MAX_FILENAME_SIZE];		// Name of the main start file
 	char alt_start[MAX_FILENAME_SIZE];	// Name of an alternative start file (e.g a config utility)
 	char images[IMAGE_BUFFER_SIZE];		// String containing all the image filenames
-	struct hwdata *hardware;				// Pointer to hardware data
+	hwdata_t hardware;					// Hardware capability mask
 } launchdat_t;
 
+// State of a name-only parse of a launch.dat held in memory
+typedef struct launchdat_name {
+	char *ptr;							// Next unread character of the file
+	char *name;							// Where to put the name
+	int found;							// Set once the name has been read, which ends the parse
+} launchdat_name_t;
+
+// An interned string in the keyword dictionary; allocated with enough extra space to hold the whole string
+typedef struct keyword {
+	struct keyword *next;				// Next keyword in the same hash bucket
+	unsigned short id;					// Id of this keyword, as stored in metadata
+	char str[1];							// The keyword itself
+} keyword_t;
+
+// A compact copy of the launch.dat fields that filters need, kept in memory for each
+// game once it has been read. Strings are held as ids in the keyword dictionary.
+typedef struct metadata {
+	unsigned short genre;				// Genre
+	unsigned short series;				// Series name
+	unsigned short publisher;			// The name of the publisher
+	unsigned short developer;			// The name of the developer
+	int year;							// Year the game was released
+	hwdata_t hardware;					// Hardware capability mask
+} metadata_t;
+
 // List of images for the current game
 typedef struct imagefile {
 	char filename[MAX_IMAGES][MAX_FILENAME_SIZE];	// Filename of an image
@@ -99,12 +169,6 @@ typedef struct imagefile {
 	short last;
 } imagefile_t;
 
-// A list of game directories to search and scrape at run time.
-typedef struct gamedir {
-	char path[MAX_PATH_SIZE];			// Path to search for games
-	struct gamedir *next;				// Link to the next search path
-} gamedir_t;
-
 // Holds the configuration of our application from launcher.ini
 typedef struct config {
 	short timers;						// Whether to time function calls
@@ -112,16 +176,34 @@ typedef struct config {
 	short save;						// Save the list of all games to a text file
 	short preload_names;				// Flag to indicate wheter a launch.dat is loaded at scrape-time to pick up real names
 	short keyboard_test;
+	short rescan;						// Ignore any saved game index and scrape all search paths again
 	char dirs[MAX_SEARCHDIRS_SIZE];	// String containing all game dirs to search - it will then be parsed into a list below:
 	struct gamedir *dir;				// List of all the game search dirs
 } config_t;
 
 // Function prototypes
+void *			arenaAlloc(unsigned int size);
+void				getArenaStats(arena_stats_t *stats);
+unsigned long	getGamedataBytes();
+unsigned long	getMetadataBytes();
+gamedata_t *		newGamedata();
+char *			getGamePath(gamedata_t *gamedata, char *buffer);
+int				setGameName(gamedata_t *gamedata, char *name);
+void				freeGamedata();
 gamedata_t *		getLastGamedata(gamedata_t *gamedata);
+int				indexGamedata(gamedata_t *gamedata);
 int				removeGamedata(gamedata_t *gamedata);
 int 				sortGamedata(gamedata_t *gamedata, int verbose);
-int 				swapGamedata(gamedata_t *gamedata1, gamedata_t *gamedata2);
+int				compareName(char *a, char *b);
 int 				getLaunchdata(gamedata_t *gamedata, launchdat_t *launchdat);
+int				getLaunchdataName(gamedata_t *gamedata, char *name);
+int				launchdatHandler(void* user, const char* section, const char* name, const char* value);
+void				launchdataDefaults(launchdat_t *launchdat);
+metadata_t *		getMetadata(gamedata_t *gamedata, launchdat_t *launchdat);
+unsigned int		addKeyword(char *value, int size);
+unsigned int		findKeyword(char *value);
+char *			getKeyword(unsigned int id);
+unsigned int		getKeywordCount();
 int 				getImageList(launchdat_t *launchdat, imagefile_t *imagefile);
 int 				getIni(config_t *config, int verbose);
 int 				getDirList(config_t *config, gamedir_t *gamedir, int verbose);
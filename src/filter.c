@@ -18,7 +18,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 
 #ifndef __HAS_DATA
 #include "data.h"
@@ -29,284 +28,303 @@
 #define __HAS_MAIN
 #endif
 #include "filter.h"
+#include "query.h"
+#include "search.h"
 #include "ui.h"
 
+// The tech spec filter strings, and the hardware capability each one matches
+static struct {
+	char *label;
+	hwdata_t mask;
+} filter_techspecs[FILTER_TECHSPECS] = {
+	{ FILTER_STRING_AUDIO_BEEPER,	HW_BEEPER },
+	{ FILTER_STRING_AUDIO_TANDY,		HW_TANDY_AUDIO },
+	{ FILTER_STRING_AUDIO_ADLIB,		HW_ADLIB },
+	{ FILTER_STRING_AUDIO_SB,		HW_SOUNDBLASTER },
+	{ FILTER_STRING_AUDIO_MT32,		HW_MT32 },
+	{ FILTER_STRING_AUDIO_GM,		HW_GM },
+	{ FILTER_STRING_AUDIO_COVOX,		HW_COVOX },
+	{ FILTER_STRING_AUDIO_DISNEY,	HW_DISNEY },
+	{ FILTER_STRING_AUDIO_GUS,		HW_ULTRASOUND },
+	{ FILTER_STRING_VIDEO_TEXT,		HW_TEXT },
+	{ FILTER_STRING_VIDEO_HERCULES,	HW_HERCULES },
+	{ FILTER_STRING_VIDEO_TANDY,		HW_TANDY_VIDEO },
+	{ FILTER_STRING_VIDEO_CGA,		HW_CGA },
+	{ FILTER_STRING_VIDEO_EGA,		HW_EGA },
+	{ FILTER_STRING_VIDEO_VGA,		HW_VGA },
+	{ FILTER_STRING_VIDEO_SVGA,		HW_SVGA },
+	{ FILTER_STRING_CPU_8086,		HW_CPU_8086 },
+	{ FILTER_STRING_CPU_80286,		HW_CPU_286 },
+	{ FILTER_STRING_CPU_80386,		HW_CPU_386 },
+	{ FILTER_STRING_CPU_80486,		HW_CPU_486 },
+	{ FILTER_STRING_CPU_80586,		HW_CPU_586 },
+	{ FILTER_STRING_RAM_XMS,			HW_RAM_XMS },
+	{ FILTER_STRING_RAM_EMS,			HW_RAM_EMS },
+	{ FILTER_STRING_MISC_DPMI,		HW_DPMI },
+};
+
+// Number of games each keyword id would match, rebuilt each time a keyword list is generated
+static unsigned short *filter_counts = NULL;
+static unsigned int filter_counts_size = 0;
+
+static int filter_CountsSize(unsigned int items){
+	// Grow the tally table to hold a count for every keyword id in the dictionary
+	
+	unsigned int size;
+	unsigned short *counts = NULL;
+	
+	if (items > filter_counts_size){
+		size = ((items + KEYWORD_BLOCK - 1) / KEYWORD_BLOCK) * KEYWORD_BLOCK;
+		counts = (unsigned short *) realloc(filter_counts, size * sizeof(unsigned short));
+		if (counts == NULL){
+			if (FILTER_VERBOSE){
+				printf("%s.%d\t Unable to allocate memory for keyword counts\n", __FILE__, __LINE__);
+			}
+			return FILTER_ERR;
+		}
+		filter_counts = counts;
+		filter_counts_size = size;
+	}
+	if (filter_counts != NULL){
+		memset(filter_counts, 0, filter_counts_size * sizeof(unsigned short));
+	}
+	return FILTER_OK;
+}
+
+hwdata_t filter_TechSpecMask(char *filter_string){
+	// Return the hardware capability bit for a tech spec filter string, or 0 if unknown
+	
+	int i;
+	
+	for(i = 0; i < FILTER_TECHSPECS; i++){
+		if (strcmp(filter_string, filter_techspecs[i].label) == 0){
+			return filter_techspecs[i].mask;
+		}
+	}
+	return 0;
+}
+
 int compare(const void *op1, const void *op2){
-	// As defined in the OpenWatcom C Library reference guide
+	// Each element is one of the string pointers of state->filter_strings
     
-    return(strcmp(*(const char**)op1, *(const char**)op1));
+    return(strcmp(*(char **)op1, *(char **)op2));
 }
 
 int sortFilterKeys(state_t *state, int items){
-	// Sort the list of filter keys by name
+	// Sort the list of filter keys by name; only the pointers move, not the strings
 	
-	qsort(state->filter_strings, items, MAX_STRING_SIZE, compare);
+	qsort(state->filter_strings, items, sizeof(char *), compare);
 	return FILTER_OK;
 }
 
-int filter_GetGenres(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
-	// Get all of the genres set in game metadata
+int filter_StringsSize(state_t *state, unsigned int items){
+	// Grow or shrink the filter string list to hold a number of strings, rounded up to a
+	// whole page of the filter popup. The strings themselves are not copied; each entry
+	// points at the one copy in the keyword dictionary, so the list only costs a few
+	// bytes for each distinct keyword. There can be no more than KEYWORD_MAX keywords,
+	// which keeps each of the tables within a single segment.
+	// If the list can't be grown it keeps its old size, and callers fill only that much.
 	
-	int i;
-	int a;
-	int c;
-	int found;
-	int status;
-	int next_pos;
-	gamedata_t *gamedata_head;
-	gamedata_head = gamedata; // Store first item
+	unsigned int size;
+	char **strings = NULL;
+	unsigned char *selected = NULL;
+	unsigned int *count = NULL;
 	
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building genre keyword selection list\n", __FILE__, __LINE__);
+	if (items > KEYWORD_MAX){
+		items = KEYWORD_MAX;
 	}
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Info - Clearing existing filter keywords list\n", __FILE__, __LINE__);
+	size = ((items + MAXIMUM_FILTER_STRINGS_PER_PAGE - 1) / MAXIMUM_FILTER_STRINGS_PER_PAGE) * MAXIMUM_FILTER_STRINGS_PER_PAGE;
+	if (size == 0){
+		size = MAXIMUM_FILTER_STRINGS_PER_PAGE;
 	}
-	// Empty list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
+	if (size == state->filter_strings_size){
+		return FILTER_OK;
 	}
 	
-	i = 0;
-	c = 0;
-	next_pos = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				// Does the genre field match?
-				if (strcmp(filterdat->genre, "") != 0){
-				
-					// Does this genre already exist?
-					found = 0;
-					for(a=0;a<MAXIMUM_FILTER_STRINGS;a++){
-						if (strcmp(state->filter_strings[a], filterdat->genre) == 0){
-							found = 1;
-						}
-					}
-					// This genre isn't found yet, add it to the list of keywords
-					if (found == 0){
-						if (FILTER_VERBOSE){
-							printf("%s.%d\t Info - Found genre: [%s]\n", __FILE__, __LINE__, filterdat->genre);
-						}
-						strncpy(state->filter_strings[next_pos], filterdat->genre, MAX_STRING_SIZE);
-						next_pos++;
-					}
-				}
-			}
+	strings = (char **) realloc(state->filter_strings, size * sizeof(char *));
+	if (strings != NULL){
+		state->filter_strings = strings;
+		selected = (unsigned char *) realloc(state->filter_strings_selected, size * sizeof(unsigned char));
+	}
+	if (selected != NULL){
+		state->filter_strings_selected = selected;
+		count = (unsigned int *) realloc(state->filter_strings_count, size * sizeof(unsigned int));
+	}
+	if (count == NULL){
+		if (FILTER_VERBOSE){
+			printf("%s.%d\t Unable to allocate memory for %u filter strings\n", __FILE__, __LINE__, size);
 		}
-		c++;
-		gamedata = gamedata->next;
+		// Anything that did grow stays grown, but only the old size is used
+		if (size < state->filter_strings_size){
+			state->filter_strings_size = size;
+		}
+		return FILTER_ERR;
 	}
+	state->filter_strings_count = count;
+	state->filter_strings_size = size;
+	return FILTER_OK;
+}
+
+void filter_StringsFree(state_t *state){
+	// Free the filter string list
 	
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Sorting keywords\n", __FILE__, __LINE__);
+	if (state->filter_strings != NULL){
+		free(state->filter_strings);
+		state->filter_strings = NULL;
 	}
-	sortFilterKeys(state, next_pos);
-	if (FILTER_VERBOSE){
-		for(a=0;a<next_pos;a++){
-			printf("%s.%d\t Info - Keyword %d: [%s]\n", __FILE__, __LINE__, a, state->filter_strings[a]);
-		}
+	if (state->filter_strings_selected != NULL){
+		free(state->filter_strings_selected);
+		state->filter_strings_selected = NULL;
+	}
+	if (state->filter_strings_count != NULL){
+		free(state->filter_strings_count);
+		state->filter_strings_count = NULL;
 	}
+	state->filter_strings_size = 0;
+	state->available_filter_strings = 0;
+	state->available_filter_pages = 0;
+}
+
+unsigned long filter_Bytes(state_t *state){
+	// Returns the bytes allocated for the filter string list and the keyword tallies
 	
-	state->available_filter_strings = next_pos;
+	unsigned long bytes;
+	
+	bytes = (unsigned long) state->filter_strings_size * (sizeof(char *) + sizeof(unsigned char) + sizeof(unsigned int));
+	bytes += (unsigned long) filter_counts_size * sizeof(unsigned short);
+	return bytes;
+}
+
+static void filter_StringsClear(state_t *state){
+	// Empty the filter string list, keeping whatever has been allocated for it
+	
+	state->available_filter_strings = 0;
+	state->available_filter_pages = 0;
 	state->current_filter_page = 0;
-	state->available_filter_pages = ceil(((float)next_pos / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
+	if (state->filter_strings_size > 0){
+		memset(state->filter_strings_selected, 0, state->filter_strings_size * sizeof(unsigned char));
+		memset(state->filter_strings_count, 0, state->filter_strings_size * sizeof(unsigned int));
 	}
+}
+
+static void filter_StringsPages(state_t *state, unsigned int items){
+	// Set the number of filter strings in the list, and how many pages of the popup they fill
 	
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d genre filters added\n", __FILE__, __LINE__, next_pos);
-		printf("%s.%d\t Total of %d pages of filters\n", __FILE__, __LINE__, state->available_filter_pages);
-	} 
-	return FILTER_OK;
+	state->available_filter_strings = items;
+	state->current_filter_page = 0;
+	state->available_filter_pages = (items + MAXIMUM_FILTER_STRINGS_PER_PAGE - 1) / MAXIMUM_FILTER_STRINGS_PER_PAGE;
 }
 
-int filter_GetSeries(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
-	// Get all of the series names set in game metadata
+static void filter_Selected(state_t *state, char *filter){
+	// Copy the filter string under the cursor, or an empty string if there isn't one
+	
+	if ((state->selected_filter_string >= 0) && ((unsigned int) state->selected_filter_string < state->available_filter_strings)){
+		strncpy(filter, state->filter_strings[state->selected_filter_string], MAX_STRING_SIZE - 1);
+		filter[MAX_STRING_SIZE - 1] = '\0';
+	} else {
+		filter[0] = '\0';
+	}
+}
+
+static int filter_GetKeywords(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat, int facet){
+	// Fill the filter string list with all of the keywords of one facet (genre, series, company)
+	// that would match any games, along with how many games picking each one would give. The
+	// counts come from the query bitsets, so any other filters already chosen are applied too.
 	
-	int i;
 	int a;
-	int c;
-	int found;
-	int status;
-	int next_pos;
-	gamedata_t *gamedata_head;
-	gamedata_head = gamedata; // Store first item
+	unsigned int next_pos;
+	unsigned int id;
+	unsigned int keywords;
 	
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building series keyword selection list\n", __FILE__, __LINE__);
+	if (query_CountKeywords(facet, gamedata, filterdat) != QUERY_OK){
+		filter_StringsClear(state);
+		return FILTER_ERR;
+	}
+	keywords = getKeywordCount();
+	if (filter_CountsSize(keywords) != FILTER_OK){
+		filter_StringsClear(state);
+		return FILTER_ERR;
+	}
+	
+	// Id 0 is always the empty string, which is never offered as a filter.
+	// Size the list to the keywords actually in use before filling it.
+	next_pos = 0;
+	for(id = 1; id < keywords; id++){
+		filter_counts[id] = query_KeywordCount(facet, id);
+		if (filter_counts[id] > 0){
+			next_pos++;
+		}
 	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing filter keywords list\n", __FILE__, __LINE__);
 	}
-	// Empty list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
+	filter_StringsSize(state, next_pos);
+	filter_StringsClear(state);
 	
-	i = 0;
-	c = 0;
 	next_pos = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				// Does the genre field match?
-				if (strcmp(filterdat->series, "") != 0){
-				
-					// Does this genre already exist?
-					found = 0;
-					for(a=0;a<MAXIMUM_FILTER_STRINGS;a++){
-						if (strcmp(state->filter_strings[a], filterdat->series) == 0){
-							found = 1;
-						}
-					}
-					// This genre isn't found yet, add it to the list of keywords
-					if (found == 0){
-						if (FILTER_VERBOSE){
-							printf("%s.%d\t Info - Found series: [%s]\n", __FILE__, __LINE__, filterdat->series);
-						}
-						strncpy(state->filter_strings[next_pos], filterdat->series, MAX_STRING_SIZE);
-						next_pos++;
-					}
+	for(id = 1; id < keywords; id++){
+		if (filter_counts[id] > 0){
+			if (next_pos >= state->filter_strings_size){
+				if (FILTER_VERBOSE){
+					printf("%s.%d\t Warning - Keyword list is full, skipping [%s]\n", __FILE__, __LINE__, getKeyword(id));
 				}
+				break;
+			}
+			if (FILTER_VERBOSE){
+				printf("%s.%d\t Info - Found keyword: [%s] (%u games)\n", __FILE__, __LINE__, getKeyword(id), filter_counts[id]);
 			}
+			state->filter_strings[next_pos] = getKeyword(id);
+			next_pos++;
 		}
-		c++;
-		gamedata = gamedata->next;
 	}
 	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Sorting keywords\n", __FILE__, __LINE__);
 	}
 	sortFilterKeys(state, next_pos);
-	if (FILTER_VERBOSE){
-		for(a=0;a<next_pos;a++){
-			printf("%s.%d\t Info - Keyword %d: [%s]\n", __FILE__, __LINE__, a, state->filter_strings[a]);
+	
+	// The counts follow the strings into their sorted positions
+	for(a=0;a<next_pos;a++){
+		state->filter_strings_count[a] = filter_counts[findKeyword(state->filter_strings[a])];
+		if (FILTER_VERBOSE){
+			printf("%s.%d\t Info - Keyword %d: [%s] (%u games)\n", __FILE__, __LINE__, a, state->filter_strings[a], state->filter_strings_count[a]);
 		}
 	}
-	state->available_filter_strings = next_pos;
-	state->current_filter_page = 0;
-	state->available_filter_pages = ceil(((float)next_pos / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
-	}
+	
+	filter_StringsPages(state, next_pos);
 	
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d series filters added\n", __FILE__, __LINE__, next_pos);
+		printf("%s.%d\t Total of %d filters added\n", __FILE__, __LINE__, next_pos);
 		printf("%s.%d\t Total of %d pages of filters\n", __FILE__, __LINE__, state->available_filter_pages);
-	}
+	} 
 	return FILTER_OK;
 }
 
-int filter_GetCompany(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
-	// Get all of the companies set in game metadata
-	
-	int i;
-	int a;
-	int c;
-	int found_dev;
-	int found_pub;
-	int status;
-	int next_pos;
-	gamedata_t *gamedata_head;
-	gamedata_head = gamedata; // Store first item
+int filter_GetGenres(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
+	// Get all of the genres set in game metadata
 	
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Building company keyword selection list\n", __FILE__, __LINE__);
-	}
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Info - Clearing existing filter keywords list\n", __FILE__, __LINE__);
-	}
-	// Empty list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
-	
-	i = 0;
-	c = 0;
-	next_pos = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				// Does the developer or publisher field match?
-				if ((strcmp(filterdat->developer, "") != 0) || (strcmp(filterdat->publisher, "") != 0)){
-				
-					// Does this company already exist?
-					found_pub = 0;
-					found_dev = 0;
-					for(a=0;a<MAXIMUM_FILTER_STRINGS;a++){
-						if (strcmp(state->filter_strings[a], filterdat->developer) == 0){
-							found_dev = 1;
-						}
-						if (strcmp(state->filter_strings[a], filterdat->publisher) == 0){
-							found_pub = 1;
-						}
-					}
-					// This company isn't found yet, add it to the list of keywords
-					if (found_dev == 0){
-						if (FILTER_VERBOSE){
-							printf("%s.%d\t Info - Found developer: [%s]\n", __FILE__, __LINE__, filterdat->developer);
-						}
-						strncpy(state->filter_strings[next_pos], filterdat->developer, MAX_STRING_SIZE);
-						next_pos++;
-					}
-					if (found_pub == 0){
-						if (FILTER_VERBOSE){
-							printf("%s.%d\t Info - Found publisher: [%s]\n", __FILE__, __LINE__, filterdat->publisher);
-						}
-						strncpy(state->filter_strings[next_pos], filterdat->publisher, MAX_STRING_SIZE);
-						next_pos++;
-					}
-				}
-			}
-		}
-		c++;
-		gamedata = gamedata->next;
+		printf("%s.%d\t Building genre keyword selection list\n", __FILE__, __LINE__);
 	}
+	return filter_GetKeywords(state, gamedata, filterdat, QUERY_GENRE);
+}
+
+int filter_GetSeries(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
+	// Get all of the series names set in game metadata
 	
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Sorting keywords\n", __FILE__, __LINE__);
-	}
-	sortFilterKeys(state, next_pos);
-	if (FILTER_VERBOSE){
-		for(a=0;a<next_pos;a++){
-			printf("%s.%d\t Info - Keyword %d: [%s]\n", __FILE__, __LINE__, a, state->filter_strings[a]);
-		}
-	}
-	state->available_filter_strings = next_pos;
-	state->current_filter_page = 0;
-	state->available_filter_pages = ceil(((float)next_pos / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
+		printf("%s.%d\t Building series keyword selection list\n", __FILE__, __LINE__);
 	}
+	return filter_GetKeywords(state, gamedata, filterdat, QUERY_SERIES);
+}
+
+int filter_GetCompany(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
+	// Get all of the companies (developers and publishers) set in game metadata
 	
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d company filters added\n", __FILE__, __LINE__, next_pos);
-		printf("%s.%d\t Total of %d pages of filters\n", __FILE__, __LINE__, state->available_filter_pages);
-	} 
-	return FILTER_OK;
+		printf("%s.%d\t Building company keyword selection list\n", __FILE__, __LINE__);
+	}
+	return filter_GetKeywords(state, gamedata, filterdat, QUERY_COMPANY);
 }
 
 
@@ -328,76 +346,65 @@ int filter_GetTechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filte
 		printf("%s.%d\t Info - Clearing existing filter keywords list\n", __FILE__, __LINE__);
 	}
 	// Empty list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
-	
-	// Audio/Sound
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_AUDIO_BEEPER, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_AUDIO_TANDY, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_AUDIO_ADLIB, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_AUDIO_SB, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_AUDIO_MT32, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_AUDIO_GM, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_AUDIO_COVOX, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_AUDIO_DISNEY, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_AUDIO_GUS, MAX_STRING_SIZE);
-	next_pos++;
-	
-	// Video
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_VIDEO_TEXT, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_VIDEO_HERCULES, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_VIDEO_TANDY, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_VIDEO_CGA, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_VIDEO_EGA, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_VIDEO_VGA, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_VIDEO_SVGA, MAX_STRING_SIZE);
-	next_pos++;
-	
-	// CPU type
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_CPU_8086, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_CPU_80286, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_CPU_80386, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_CPU_80486, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_CPU_80586, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_RAM_XMS, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_RAM_EMS, MAX_STRING_SIZE);
-	next_pos++;
-	strncpy(state->filter_strings[next_pos], FILTER_STRING_MISC_DPMI, MAX_STRING_SIZE);
-	next_pos++;
+	if (filter_StringsSize(state, FILTER_TECHSPECS) != FILTER_OK){
+		filter_StringsClear(state);
+		return FILTER_ERR;
+	}
+	filter_StringsClear(state);
+	
+	// Audio, video and cpu/misc labels
+	for(i = 0; i < FILTER_TECHSPECS; i++){
+		state->filter_strings[next_pos] = filter_techspecs[i].label;
+		next_pos++;
+	}
 	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Sorting keywords\n", __FILE__, __LINE__);
 	}
 	sortFilterKeys(state, next_pos);
+	filter_StringsPages(state, next_pos);
 	
-	state->available_filter_strings = next_pos;
-	state->current_filter_page = 0;
-	state->available_filter_pages = ceil(((float)next_pos / (float)MAXIMUM_FILTER_STRINGS_PER_PAGE));
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
+	// Nothing is selected yet, so each count is the number of games with that capability
+	// among those matched by any genre, series or company filters
+	filter_CountTechSpecs(state, gamedata, filterdat);
+	
+	return FILTER_OK;
+}
+
+int filter_CountTechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
+	// Set the count against each tech spec filter string to the number of games that would
+	// match if that capability was added to the ones currently selected, together with any
+	// genre, series or company filters. Called again whenever a tech spec is toggled, so
+	// the counts always reflect the combined filter.
+	
+	int i;
+	int f;
+	hwdata_t query;
+	hwdata_t masks[FILTER_TECHSPECS];
+	
+	// Mask of everything that is already selected
+	query = 0;
+	for(f = 0; f < FILTER_TECHSPECS; f++){
+		masks[f] = filter_TechSpecMask(state->filter_strings[f]);
+		state->filter_strings_count[f] = 0;
+		if (state->filter_strings_selected[f] == 1){
+			query |= masks[f];
+		}
+	}
+	
+	// Games without metadata have no capabilities, so are never in any of the counts
+	if (query_CountHardware(query, gamedata, filterdat) != QUERY_OK){
+		return FILTER_ERR;
+	}
+	for(f = 0; f < FILTER_TECHSPECS; f++){
+		state->filter_strings_count[f] = query_HardwareCount(masks[f]);
 	}
 	
+	if (FILTER_VERBOSE){
+		for(i = 0; i < FILTER_TECHSPECS; i++){
+			printf("%s.%d\t Info - Tech spec %d: [%s] (%u games)\n", __FILE__, __LINE__, i, state->filter_strings[i], state->filter_strings_count[i]);
+		}
+	}
 	return FILTER_OK;
 }
 
@@ -409,26 +416,34 @@ int filter_None(state_t *state, gamedata_t *gamedata){
 	
 	gamedata_head = gamedata; // Store first item
 	
+	// Any combined filters are dropped as well
+	query_Clear();
+	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Building unfiltered selection list\n", __FILE__, __LINE__);
 	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
 	}
-	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
+	// Size the list to fit every game, then empty it
+	i = 0;
+	while(gamedata != NULL){
+		gamedata = gamedata->next;
+		i++;
+	}
+	gamedata = gamedata_head;
+	query_SelectionSize(state, i);
+	for(i =0; i <state->selected_size; i++){
 		state->selected_list[i] = -1;
 	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing filter string list\n", __FILE__, __LINE__);
 	}
 	// Empty filter string list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
+	filter_StringsClear(state);
 	
 	i = 0;
-	while(gamedata != NULL){
+	while((gamedata != NULL) && (i < state->selected_size)){
 		if (FILTER_VERBOSE){
 			printf("%s.%d\t Info - adding Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
 		}
@@ -443,516 +458,149 @@ int filter_None(state_t *state, gamedata_t *gamedata){
 	state->selected_max = i; 	// Number of items in selection list
 	state->selected_page = 1;	// Start on page 1
 	state->selected_line = 0;	// Start on line 0
-	state->total_pages = 0;	
 	state->selected_filter_string = 0;
-	state->current_filter_page = 0;
-	state->available_filter_pages = 0;
 	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
 	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
-		}
-	}
-	for(i = 0; i < MAXIMUM_FILTER_STRINGS; i++){
-		state->filter_strings_selected[i] = 0;
-	}
+	query_SelectionPages(state);
+	search_IndexPrefix(state, gamedata);
 	
 	return FILTER_OK;
 }
 
 int filter_Genre(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
 	// Filter all games on a specific genre string
-	int i;
-	int c;
+	// The choice replaces any previous genre filter, but is combined with any
+	// other filters that are already active.
 	int status;
-	gamedata_t *gamedata_head;
+	unsigned int id;
 	char filter[MAX_STRING_SIZE];
 	
-	strncpy(filter, state->filter_strings[state->selected_filter_string], MAX_STRING_SIZE);
-	
-	gamedata_head = gamedata; // Store first item
+	filter_Selected(state, filter);
+	id = findKeyword(filter);
 	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Building genre selection list [%s]\n", __FILE__, __LINE__, filter);
 	}
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
-	}
-	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
-	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing filter string list\n", __FILE__, __LINE__);
 	}
 	// Empty filter string list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
+	filter_StringsClear(state);
 	
-	state->selected_max = 0; 	
-	state->selected_page = 1;	
-	state->selected_line = 0;	
-	state->total_pages = 0;		
-	state->selected_gameid = -1;
-	state->selected_game = NULL;
+	query_ClearFacet(QUERY_GENRE);
+	query_AddKeyword(QUERY_GENRE, id);
+	status = query_Run(state, gamedata, filterdat);
 	
-	i = 0;
-	c = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Info - Checking %s == %s\n", __FILE__, __LINE__, filterdat->genre, filter);
-				}
-				
-				// Does the genre field match?
-				if (strncmp(filterdat->genre, filter, MAX_STRING_SIZE) == 0){
-				
-					if (FILTER_VERBOSE){
-						printf("%s.%d\t Info - adding Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-					}
-					
-					// Add the selected gameid to the selection list
-					state->selected_list[i] = gamedata->gameid;
-					i++;
-				}
-			} else {
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Warning, metadata not loaded for Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-				}
-			}
-		}
-		c++;
-		gamedata = gamedata->next;
-	}
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d filtered games in genre list\n", __FILE__, __LINE__, i);
+		printf("%s.%d\t Total of %d filtered games in genre list\n", __FILE__, __LINE__, state->selected_max);
 	} 
-	
-	gamedata = gamedata_head;
-	state->selected_max = i; 	// Number of items in selection list
-	state->selected_page = 1;	// Start on page 1
-	state->selected_line = 0;	// Start on line 0
-	state->total_pages = 0;		
-	state->selected_filter_string = 0;
-	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
-	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
-		}
+	if (status != QUERY_OK){
+		return FILTER_ERR;
 	}
 	return FILTER_OK;
 }
 
 int filter_Series(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
 	// Filter all games on a specific series string
-	int i;
-	int c;
+	// The choice replaces any previous series filter, but is combined with any
+	// other filters that are already active.
 	int status;
-	gamedata_t *gamedata_head;
+	unsigned int id;
 	char filter[MAX_STRING_SIZE];
-	gamedata_head = gamedata; // Store first item
 	
-	strncpy(filter, state->filter_strings[state->selected_filter_string], MAX_STRING_SIZE);
+	filter_Selected(state, filter);
+	id = findKeyword(filter);
 	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Building series selection list [%s]\n", __FILE__, __LINE__, filter);
 	}
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
-	}
-	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
-	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing filter string list\n", __FILE__, __LINE__);
 	}
 	// Empty filter string list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
+	filter_StringsClear(state);
 	
-	state->selected_max = 0; 	
-	state->selected_page = 1;	
-	state->selected_line = 0;	
-	state->total_pages = 0;		
-	state->selected_gameid = -1;
-	state->selected_game = NULL;
+	query_ClearFacet(QUERY_SERIES);
+	query_AddKeyword(QUERY_SERIES, id);
+	status = query_Run(state, gamedata, filterdat);
 	
-	i = 0;
-	c = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Info - Checking %s == %s\n", __FILE__, __LINE__, filterdat->series, filter);
-				}
-				
-				// Does the genre field match?
-				if (strncmp(filterdat->series, filter, MAX_STRING_SIZE) == 0){
-				
-					if (FILTER_VERBOSE){
-						printf("%s.%d\t Info - adding Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-					}
-					
-					// Add the selected gameid to the selection list
-					state->selected_list[i] = gamedata->gameid;
-					i++;
-				}
-			} else {
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Warning, metadata not loaded for Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-				}
-			}
-		}
-		c++;
-		gamedata = gamedata->next;
-	}
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d filtered games in series list\n", __FILE__, __LINE__, i);
+		printf("%s.%d\t Total of %d filtered games in series list\n", __FILE__, __LINE__, state->selected_max);
 	} 
-	
-	gamedata = gamedata_head;
-	state->selected_max = i; 	// Number of items in selection list
-	state->selected_page = 1;	// Start on page 1
-	state->selected_line = 0;	// Start on line 0
-	state->total_pages = 0;		
-	state->selected_filter_string = 0;
-	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
-	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
-		}
+	if (status != QUERY_OK){
+		return FILTER_ERR;
 	}
 	return FILTER_OK;
 }
 
 int filter_Company(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
 	// Filter all games on a specific developer or publisher string
-	int i;
-	int c;
+	// The choice replaces any previous company filter, but is combined with any
+	// other filters that are already active.
 	int status;
-	gamedata_t *gamedata_head;
+	unsigned int id;
 	char filter[MAX_STRING_SIZE];
 	
-	strncpy(filter, state->filter_strings[state->selected_filter_string], MAX_STRING_SIZE);
-	
-	gamedata_head = gamedata; // Store first item
+	filter_Selected(state, filter);
+	id = findKeyword(filter);
 	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Building company selection list [%s]\n", __FILE__, __LINE__, filter);
 	}
-	if (FILTER_VERBOSE){
-		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
-	}
-	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
-	}
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Info - Clearing existing filter string list\n", __FILE__, __LINE__);
 	}
 	// Empty filter string list
-	for(i =0; i <MAXIMUM_FILTER_STRINGS; i++){
-		memset(state->filter_strings[i], '\0', MAX_STRING_SIZE);
-	}
+	filter_StringsClear(state);
 	
-	state->selected_max = 0; 	
-	state->selected_page = 1;	
-	state->selected_line = 0;	
-	state->total_pages = 0;		
-	state->selected_gameid = -1;
-	state->selected_game = NULL;
+	query_ClearFacet(QUERY_COMPANY);
+	query_AddKeyword(QUERY_COMPANY, id);
+	status = query_Run(state, gamedata, filterdat);
 	
-	i = 0;
-	c = 0;
-	while(gamedata != NULL){
-		
-		// Does game have metadata
-		if (gamedata->has_dat){
-			
-			// Load launch metadata
-			status = getLaunchdata(gamedata, filterdat);
-			if (status == 0){
-				
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Info - Checking %s OR %s == %s\n", __FILE__, __LINE__, filterdat->developer, filterdat->publisher, filter);
-				}
-				
-				// Does the publisher or developer field match?
-				if ((strncmp(filterdat->developer, filter, MAX_STRING_SIZE) == 0) || (strncmp(filterdat->publisher, filter, MAX_STRING_SIZE) == 0)){
-				
-					if (FILTER_VERBOSE){
-						printf("%s.%d\t Yes - adding Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-					}
-					
-					// Add the selected gameid to the selection list
-					state->selected_list[i] = gamedata->gameid;
-					i++;
-				}
-			} else {
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t Warning, metadata not loaded for Game ID: [%d], %s\n", __FILE__, __LINE__, gamedata->gameid, gamedata->name);
-				}
-			}
-		}
-		c++;
-		gamedata = gamedata->next;
-	}
 	if (FILTER_VERBOSE){
-		printf("%s.%d\t Searched %d games\n", __FILE__, __LINE__, c);
-		printf("%s.%d\t Total of %d filtered games in company list\n", __FILE__, __LINE__, i);
+		printf("%s.%d\t Total of %d filtered games in company list\n", __FILE__, __LINE__, state->selected_max);
 	} 
-	
-	gamedata = gamedata_head;
-	state->selected_max = i; 	// Number of items in selection list
-	state->selected_page = 1;	// Start on page 1
-	state->selected_line = 0;	// Start on line 0
-	state->total_pages = 0;		
-	state->selected_filter_string = 0;
-	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
-	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
-		}
+	if (status != QUERY_OK){
+		return FILTER_ERR;
 	}
 	return FILTER_OK;
 }
 
 int filter_TechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
 	// Filter the list of games based on one or more selected technical criteria
-	// set in the state->filter_strings_selected array
+	// set in the state->filter_strings_selected array. The selection replaces any
+	// previous tech spec filter, but is combined with any other active filters.
 	
-	char filter_string[MAX_STRING_SIZE];
-	int i, f;
+	int f;
 	int status;
-	unsigned short added_list[SELECTION_LIST_SIZE];
-	unsigned char continue_search;
-	
-	gamedata_t *gamedata_head;
-	
-	gamedata_head = gamedata; // Store first item
+	hwdata_t query;
 	
 	if (FILTER_VERBOSE){
 		printf("%s.%d\t Building tech specs selection list\n", __FILE__, __LINE__);
-		printf("%s.%d\t Info - Clearing existing selection list\n", __FILE__, __LINE__);
-	}
-	// Empty list
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
-		state->selected_list[i] = -1;
 	}
 	
-	// Determine if we are filtering any of cpu/video/audio tech specs
-	if (FILTER_VERBOSE){
-		for(f = 0; f <MAXIMUM_FILTER_STRINGS; f++){
-			if (state->filter_strings_selected[f] == 1){
+	// Turn the selected tech spec strings into a single mask of hardware capabilities
+	query = 0;
+	for(f = 0; f < state->available_filter_strings; f++){
+		if (state->filter_strings_selected[f] == 1){
+			if (FILTER_VERBOSE){
 				printf("%s.%d\t - Adding filter for: %s\n", __FILE__, __LINE__, state->filter_strings[f]);
 			}
+			query |= filter_TechSpecMask(state->filter_strings[f]);
 		}
 	}
 	
-	i = 0;
-	while(gamedata != NULL){
-		
-		if (FILTER_VERBOSE){
-			printf("%s.%d\t Searching for matches in %s\n", __FILE__, __LINE__, gamedata->name);
-		}
-		// Does game have metadata
-		if (gamedata->has_dat){
-			status = getLaunchdata(gamedata, filterdat);
-			// Was metadata loaded
-			if (status == 0){
-				continue_search = 1;
-				// Yes, search for matching filter strings
-				for(f = 0; f <MAXIMUM_FILTER_STRINGS; f++){
-					
-					// This filter is selected
-					if (state->filter_strings_selected[f] == 1){
-
-						// Audio search criteria .........................
-						
-						if (strcmp(state->filter_strings[f], FILTER_STRING_AUDIO_BEEPER) == 0){
-							if (filterdat->hardware->beeper != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_AUDIO_TANDY) == 0){
-							if (filterdat->hardware->tandy_audio != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_AUDIO_ADLIB) == 0){
-							if (filterdat->hardware->adlib != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_AUDIO_SB) == 0){
-							if (filterdat->hardware->soundblaster != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_AUDIO_MT32) == 0){
-							if (filterdat->hardware->mt32 != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_AUDIO_GM) == 0){
-							if (filterdat->hardware->gm != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_AUDIO_COVOX) == 0){
-							if (filterdat->hardware->covox != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_AUDIO_DISNEY) == 0){
-							if (filterdat->hardware->disney != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_AUDIO_GUS) == 0){
-							if (filterdat->hardware->ultrasound != 1){
-								continue_search = 0;
-							}
-						}
-						
-						// Video search criteria .........................
-						if (strcmp(state->filter_strings[f], FILTER_STRING_VIDEO_TEXT) == 0){
-							if (filterdat->hardware->text != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_VIDEO_HERCULES) == 0){
-							if (filterdat->hardware->hercules != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_VIDEO_TANDY) == 0){
-							if (filterdat->hardware->tandy_video != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_VIDEO_CGA) == 0){
-							if (filterdat->hardware->cga != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_VIDEO_EGA) == 0){
-							if (filterdat->hardware->ega != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_VIDEO_VGA) == 0){
-							if (filterdat->hardware->vga != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_VIDEO_SVGA) == 0){
-							if (filterdat->hardware->svga != 1){
-								continue_search = 0;
-							}
-						}
-						
-						// CPU/Misc search criteria .........................
-						if (strcmp(state->filter_strings[f], FILTER_STRING_CPU_8086) == 0){
-							if (filterdat->hardware->cpu_8086 != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_CPU_80286) == 0){
-							if (filterdat->hardware->cpu_286 != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_CPU_80386) == 0){
-							if (filterdat->hardware->cpu_386 != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_CPU_80486) == 0){
-							if (filterdat->hardware->cpu_486 != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_CPU_80586) == 0){
-							if (filterdat->hardware->cpu_586 != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_RAM_XMS) == 0){
-							if (filterdat->hardware->ram_xms != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_RAM_EMS) == 0){
-							if (filterdat->hardware->ram_ems != 1){
-								continue_search = 0;
-							}
-						}
-						if (strcmp(state->filter_strings[f], FILTER_STRING_MISC_DPMI) == 0){
-							if (filterdat->hardware->dpmi != 1){
-								continue_search = 0;
-							}
-						}
-					}
-					
-					// The search is a composite AND statement,
-					// if any of the results is false, then we
-					// exit out of the search loop for this game.
-					if (continue_search != 1){
-						break;	
-					}
-				}
-			}
-			
-			// If continue_search was still set, then this search must
-			// have satisfied all critera. Therefore add it to the found list.
-			if (continue_search == 1){
-				if (FILTER_VERBOSE){
-					printf("%s.%d\t - All criteria matched for %s\n", __FILE__, __LINE__, filterdat->realname);
-				}
-				state->selected_list[i] = gamedata->gameid;
-				i++;	
-			}
-		}
-		gamedata = gamedata->next;
-	}
+	// The search is a composite AND statement, so every
+	// selected capability must be set for a game to match.
+	query_SetHardware(query);
+	status = query_Run(state, gamedata, filterdat);
 	
-	gamedata = gamedata_head;	// Restore head
-	state->selected_max = i; 	// Number of items in selection list
-	state->selected_page = 1;	// Start on page 1
-	state->selected_line = 0;	// Start on line 0
-	state->total_pages = 0;		
-	state->selected_filter_string = 0;
-	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
-	state->selected_game = getGameid(state->selected_gameid, gamedata);
-	for(i = 0; i <= state->selected_max ; i++){
-		if (i % ui_browser_max_lines == 0){
-			state->total_pages++;
-		}
+	if (FILTER_VERBOSE){
+		printf("%s.%d\t Total of %d filtered games in tech specs list\n", __FILE__, __LINE__, state->selected_max);
+	}
+	if (status != QUERY_OK){
+		return FILTER_ERR;
 	}
-	
 	return FILTER_OK;
 	
 }
@@ -56,14 +56,20 @@
 #define FILTER_STRING_RAM_XMS		"RAM: Extended XMS"
 #define FILTER_STRING_RAM_EMS		"RAM: Expanded EMS"
 #define FILTER_STRING_MISC_DPMI		"Misc: DPMI"
+#define FILTER_TECHSPECS				24		// Number of tech spec filter strings above
 
 // Function prototypes
 int filter_GetGenres(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
 int filter_GetSeries(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
 int filter_GetCompany(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
 int filter_GetTechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
+int filter_CountTechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
 int filter_None(state_t *state, gamedata_t *gamedata);
 int filter_Genre(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
 int filter_Series(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
 int filter_Company(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
 int filter_TechSpecs(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
+hwdata_t filter_TechSpecMask(char *filter_string);
+int filter_StringsSize(state_t *state, unsigned int items);
+void filter_StringsFree(state_t *state);
+unsigned long filter_Bytes(state_t *state);
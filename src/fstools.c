@@ -19,14 +19,14 @@
 #include <string.h>
 #include <stdlib.h>
 
-#include <dos.h>
-#include <direct.h>
-
 #ifndef __HAS_DATA
 #include "data.h"
 #define __HAS_DATA
 #endif
 #include "fstools.h"
+#include "cache.h"
+#include "names.h"
+#include "platform.h"
 
 char drvNumToLetter(int drive_number){
 	/* Turn a drive number into a drive letter */
@@ -105,66 +105,84 @@ int dirFromPath(char *path, char *buffer){
 int isDir(char *path){
 	/* Boolean test to check if a path is a directory or not */
 
-	DIR *dir;
+	platform_dir_t *dir;
 	int dir_type;
 	
-	dir = opendir(path);
+	dir = platform_OpenDir(path);
 	if (dir != NULL){
 		dir_type = 1;
+		platform_CloseDir(dir);
 	} else {
 		dir_type = 0;	
 	}
-	closedir(dir);
 	return dir_type;
 }
 
-int dirHasData(char *path){
-	/* Return 1 if a __launch.dat file is found in a given directory, 0 if missing */
+int dirStamp(char *path, unsigned short *date, unsigned short *time){
+	/* Return the DOS date and time stamp of the directory entry for a given path */
 	
-	FILE *f;
-	int found;
-	char filepath[DIR_BUFFER_SIZE];
+	*date = 0;
+	*time = 0;
+	
+	if (platform_DirStamp(path, date, time) != PLATFORM_OK){
+		if (FS_VERBOSE){
+			printf("%s.%d\t Unable to read directory stamp [path:%s]\n", __FILE__, __LINE__, path);
+		}
+		return -1;
+	}
+	return 0;
+}
+
+int dirHasData(char *path, unsigned long *size, unsigned short *date, unsigned short *time){
+	/* Return 1 if a __launch.dat file is found in a given directory, 0 if missing. The size and
+	   date and time stamp of the file are returned as well, or all zero if it is missing, so that
+	   the index can tell when it has been added, edited or removed. */
+	
+	char filepath[MAX_GAMEPATH_SIZE + MAX_FILENAME_SIZE];
 	
 	strcpy(filepath, path);
 	strcat(filepath, "\\");
 	strcat(filepath, GAMEDAT);
 	
-	f = fopen(filepath, "r");
-	if (f != NULL){
-		found = 1;
-	} else {
-		found = 0;	
+	if (platform_FileStamp(filepath, size, date, time) != PLATFORM_OK){
+		*size = 0;
+		*date = 0;
+		*time = 0;
+		return 0;
 	}
-	fclose(f);
-	return found;
+	return 1;
 }
 
-int findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, launchdat_t *launchdat){
+int findDirs(gamedir_t *gamedir, gamedata_t *gamedata, int startnum, config_t *config, launchdat_t *launchdat, gamedata_t *previous){
 	/* Open a search path and return a count of any directories found, creating a gamedata object for each one. */
 	
-	// path: Fully qualified path to search, e.g. "A:\Games"
+	// gamedir: The search path entry to scan, with a fully qualified path, e.g. "A:\Games"
 	// gamedata: An instance of the linked-list of game data
 	// startnum: The starting number to tag each found 'game' with the next auto-incrementing ID
+	// previous: Games found under this search path on the previous run, or NULL to scrape everything
 	
-	unsigned drive, old_drive, drives;
-	char drive_letter, old_drive_letter;
+	unsigned old_drive;
 	char status;
 	int go;
 	int found;
-	DIR *dir;
-	struct dirent *de;
+	unsigned short entries;
+	platform_dir_t *dir;
+	platform_dirent_t *de;
+	char *path;
+	gamedata_t *carried = NULL;
 	
 	/* store directory names */
 	char old_dir_buffer[DIR_BUFFER_SIZE];
 	
 	/* hold information about search path */
 	char search_drive;
-	char search_dirname[DIR_BUFFER_SIZE];
+	char search_dirname[MAX_GAMEPATH_SIZE];
 	
 	/* initialise counters */
+	path = gamedir->path;
 	go = 1;
 	found = 0;
-	drive = 0;
+	entries = 0;
 	old_drive = 0;
 	
 	/* initialise the directory or search dirname buffer */
@@ -179,76 +197,95 @@ int findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, l
 	}
 	
 	/* save curdrive */
-	_dos_getdrive(&old_drive);
+	old_drive = platform_GetDrive();
 	if (old_drive == 0){
 		printf("%s.%d\t Unable to save current drive [status:%d]\n", __FILE__, __LINE__, old_drive);
 		return -1;
 	}
 	
 	/* save curdir */
-	getcwd(old_dir_buffer, DIR_BUFFER_SIZE);
+	platform_GetDir(old_dir_buffer, DIR_BUFFER_SIZE);
+	
+	/* new games are always added at the end of the list */
+	gamedata = getLastGamedata(gamedata);
 
 	if (isDir(path)){				
 		/* change to actual search path */
-		status = chdir(path);
+		status = platform_ChangeDir(path);
 		if (status != 0){
 			printf("%s.%d\t Unable to change to search path [status:%d][path:%s]\n", __FILE__, __LINE__, status, path);
 		} else {
 			// Open the directory entry for this search path
-			dir = opendir(path);
+			dir = platform_OpenDir(path);
 			if (dir != NULL){
 				// Read an entry for the directory entry
-				while (de = readdir(dir)){
+				while ((de = platform_ReadDir(dir)) != NULL){
 					// Skip any names that are "." and ".."
-					if (strcmp(de->d_name, ".") != 0 && strcmp(de->d_name, "..") != 0){
-						// Only process entries that are of type DT_DIR (e.g. sub-directory names)						
-						memset(search_dirname, '\0', sizeof(search_dirname));
-						strcpy(search_dirname, path);
-						strcat(search_dirname, "\\");
-						strcat(search_dirname, de->d_name);
-						if (isDir(search_dirname)){
+					if (strcmp(de->name, ".") != 0 && strcmp(de->name, "..") != 0){
+						entries++;
+						
+						// Carry over any game directory which is unchanged since the previous run
+						if ((previous != NULL) && (de->is_dir)){
+							carried = cache_TakeGame(previous, de->name, de->date, de->time);
+							if (carried != NULL){
+								if (FS_VERBOSE){
+									printf("%s.%d\t Unchanged: %s\\%s\n", __FILE__, __LINE__, path, carried->leaf);
+								}
+								found++;
+								carried->gameid = startnum;
+								carried->dir = gamedir;
+								gamedata->next = carried;
+								gamedata = gamedata->next;
+								startnum++;
+								continue;
+							}
+						}
+						
+						// Only process entries that are sub-directories; the attribute comes with
+						// the directory entry itself, so there's no need to try and open it
+						if (de->is_dir){
+							memset(search_dirname, '\0', sizeof(search_dirname));
+							strcpy(search_dirname, path);
+							strcat(search_dirname, "\\");
+							strcat(search_dirname, de->name);
 							if (FS_VERBOSE){
 								printf("%s.%d\t ID: %d\n", __FILE__, __LINE__, startnum);
-								printf("%s.%d\t Name: %s\n", __FILE__, __LINE__, de->d_name);
+								printf("%s.%d\t Name: %s\n", __FILE__, __LINE__, de->name);
 								printf("%s.%d\t Drive: %c\n", __FILE__, __LINE__, search_drive);
 								printf("%s.%d\t Path: %s\n", __FILE__, __LINE__, search_dirname);
 								printf("%s.%d\t Full Path: %s\n", __FILE__, __LINE__, search_dirname);
-								printf("%s.%d\t Has dat: %d\n", __FILE__, __LINE__, dirHasData(search_dirname));
+							}
+							gamedata->next = newGamedata();
+							if (gamedata->next == NULL){
+								printf("%s.%d\t Unable to allocate memory for game [%s]\n", __FILE__, __LINE__, search_dirname);
+								break;
 							}
 							found++;
-							gamedata = getLastGamedata(gamedata);
-							gamedata->next = (gamedata_t *) calloc(sizeof(gamedata_t), 1);
 							gamedata->next->gameid = startnum;
-							gamedata->next->drive =search_drive;
-							strncpy(gamedata->next->path, search_dirname, 65);
-							strncpy(gamedata->next->name, de->d_name, MAX_FILENAME_SIZE);
-							gamedata->next->has_dat = dirHasData(search_dirname);
+							strcpy(gamedata->next->leaf, de->name);
+							gamedata->next->date = de->date;
+							gamedata->next->time = de->time;
+							gamedata->next->dir = gamedir;
 							
-							// If pre-loading names from launchdat
-							if (gamedata->next->has_dat == 1){
-								if (config->preload_names == 1){
-									if (FS_VERBOSE){
-										printf("%s.%d\t Preloading realname\n", __FILE__, __LINE__);
-									}
-									status = getLaunchdata(gamedata->next, launchdat);
-									if (status == 0){
-										if (FS_VERBOSE){
-											printf("%s.%d\t Realname: %s\n", __FILE__, __LINE__, launchdat->realname);
-										}
-										strncpy(gamedata->next->name, launchdat->realname, MAX_NAME_SIZE);
-									} else {
-										if (FS_VERBOSE){
-											printf("%s.%d\t Metadata not found!\n", __FILE__, __LINE__);
-										}
-									}
-								}
+							gamedata->next->has_dat = dirHasData(search_dirname, &gamedata->next->dat_size, &gamedata->next->dat_date, &gamedata->next->dat_time);
+							if ((config->preload_names == 1) && (gamedata->next->has_dat)){
+								// The real name is loaded later, while the main loop is idle,
+								// so that scraping only has to look at directory entries
+								gamedata->next->has_name = NAMES_PENDING;
+							} else {
+								gamedata->next->has_name = NAMES_RESOLVED;
+							}
+							if (FS_VERBOSE){
+								printf("%s.%d\t Has dat: %d\n", __FILE__, __LINE__, gamedata->next->has_dat);
 							}
 							gamedata->next->next = NULL;
+							gamedata = gamedata->next;
 							startnum++;
 						}
 					}
 				}
-				closedir(dir);
+				platform_CloseDir(dir);
+				gamedir->entries = entries;
 			}
 		}
 	} else {
@@ -256,8 +293,8 @@ int findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, l
 	}
 	
 	/* reload current drive and directory */
-	_dos_setdrive(old_drive, &drives);
-	status = chdir(old_dir_buffer);
+	platform_SetDrive(old_drive);
+	status = platform_ChangeDir(old_dir_buffer);
 	if (status != 0){
 		printf("%s.%d\t Unable to restore directory [status:%d\n", __FILE__, __LINE__, status);
 		return -1;
@@ -285,7 +322,9 @@ int writeRunBat(state_t *state, launchdat_t *launchdat){
 	// from the launchdat file at application exit.
 	
 	FILE *runbat;
+	char game_path[MAX_GAMEPATH_SIZE];
 	
+	getGamePath(state->selected_game, game_path);
 	runbat = fopen(RUNBAT, "w");
 	if (runbat != NULL){
 		if (FS_VERBOSE){
@@ -301,18 +340,18 @@ int writeRunBat(state_t *state, launchdat_t *launchdat){
 	if (FS_VERBOSE){
 		fprintf(runbat, "REM ID: %d\n", state->selected_game->gameid);
 		fprintf(runbat, "REM Name: %s\n", state->selected_game->name);
-		fprintf(runbat, "REM Drive: %c\n", state->selected_game->drive);
-		fprintf(runbat, "REM Path: %s\n", state->selected_game->path);
+		fprintf(runbat, "REM Drive: %c\n", drvLetterFromPath(game_path));
+		fprintf(runbat, "REM Path: %s\n", game_path);
 		fprintf(runbat, "REM Start: %s\n", launchdat->start);
 		fprintf(runbat, "REM Alt Start: %s\n", launchdat->alt_start);
 		fputs("\n", runbat);
 	}
 	
 	// Change to game drive
-	fprintf(runbat, "%c: \n", state->selected_game->drive);
-
+	fprintf(runbat, "%c: \n", drvLetterFromPath(game_path));
+	
 	// CD to game directory
-	fprintf(runbat, "cd %s \n", state->selected_game->path);
+	fprintf(runbat, "cd %s \n", game_path);
 	
 	// Call selected start file
 	if (state->selected_start == 0){
@@ -32,11 +32,12 @@
 
 // Fuction prototypes
 int 		dirFromPath(char *path, char *buffer);
-int 		dirHasData(char *path);
+int 		dirHasData(char *path, unsigned long *size, unsigned short *date, unsigned short *time);
+int 		dirStamp(char *path, unsigned short *date, unsigned short *time);
 char 	drvLetterFromPath(char *path);
 int 		drvLetterToNum(char drive_letter);
 char		drvNumToLetter(int drive_number);
-int 		findDirs(char *path, gamedata_t *gamedata, int startnum, config_t *config, launchdat_t *launchdat);
+int 		findDirs(gamedir_t *gamedir, gamedata_t *gamedata, int startnum, config_t *config, launchdat_t *launchdat, gamedata_t *previous);
 int 		isDir(char *path);
 int 		writeRunBat(state_t *state, launchdat_t *launchdat);
 int 		zeroRunBat();
@@ -21,10 +21,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
-#include <dos.h>
 
 #include "gfx.h"
-#include "vesa.h"
+#include "platform.h"
 #include "utils.h"
 
 #ifndef __HAS_PAL
@@ -41,139 +40,51 @@ unsigned char __huge	*vram;					// Pointer to a location in the local graphics b
 unsigned char __huge	vram_buffer[VRAM_END]; 	// Our local memory graphics buffer, GFX_ROWS * GFX_COLS * GFX_PIXEL_SIZE
 long int window_x_max; 						// How many pixels wide a vesa memory window is
 long int window_y_max; 						// How many pixels deep a vesa memory window is
-long int vga_segment; 						// Base address of the current vesa memory window
 long int windows_in_use;						// Number of video memory windows needed to map our GFX_ROWS * GFX_COLS screen
 long int window_bytes;						// NUmber of bytes in a single vesa memory window (nominally 65536)
-unsigned char *VGA=(unsigned char *)0xA0000000L; // Position of the VGA memory region
 unsigned char vga_dac_type = VGA_PALETTE_6BPP;
 
+// The part of each row of vram_buffer drawn to since the last flip, from dirty_start up to
+// but not including dirty_end. A dirty_end of 0 marks a row with nothing to copy.
+static unsigned short dirty_start[GFX_ROWS];
+static unsigned short dirty_end[GFX_ROWS];
+static int dirty_first = GFX_ROWS;				// First row with anything to copy
+static int dirty_last = -1;					// Last row with anything to copy
+static unsigned long flip_bytes = 0;			// Bytes copied to video memory since gfx_FlipBytes() was last called
+
 int gfx_Init(){
 	// Initialise graphics to a set of configured defaults
 	
 	
 	int status;
 	double window_bytes_t;
-	vbeinfo_t *vbeinfo = NULL;
-	vesamodeinfo_t *vesamodeinfo = NULL;
-	
-	vbeinfo = (vbeinfo_t *) malloc(sizeof(vbeinfo_t));
-	vesamodeinfo = (vesamodeinfo_t *) malloc(sizeof(vesamodeinfo_t));
 	
 	if (GFX_VERBOSE){
 		printf("%s.%d\t gfx_Init() Initalising gfx mode\n", __FILE__, __LINE__);	
 	}
 	
-	// Look for a VESA BIOS structure
-	status = vesa_GetVBEInfo(vbeinfo);
-	if (status < 0){
-		if (GFX_VERBOSE){
-			printf("%s.%d\t gfx_Init() Error, Unable to complete gfx initialisation [VBE BIOS missing]\n", __FILE__, __LINE__);	
-		}
-		free(vbeinfo);
-		free(vesamodeinfo);
-		return -1;	
-	} else {	
-		if (GFX_VERBOSE){
-			printf("%s.%d\t gfx_Init() Found a VESA BIOS\n", __FILE__, __LINE__);	
-		}
-	}
-		
-	// Find mode GFX_VESA_DESIRED
-	status = vesa_HasMode(GFX_VESA_DESIRED, vbeinfo);
-	if (status < 0){
-		if (GFX_VERBOSE){
-			printf("%s.%d\t gfx_Init() Error, Unable to complete gfx initialisation [VESA mode missing]\n", __FILE__, __LINE__);	
-		}
-		free(vbeinfo);
-		free(vesamodeinfo);
-		return -1;	
-	} else {	
-		if (GFX_VERBOSE){
-			printf("%s.%d\t gfx_Init() Found VESA mode %xh\n", __FILE__, __LINE__, GFX_VESA_DESIRED);	
-		}
-	}
-	
-	// Load the mode information
-	status = vesa_GetModeInfo(GFX_VESA_DESIRED, vesamodeinfo);
+	// Find and set mode GFX_VESA_DESIRED, and the widest VGA DAC we can get
+	status = platform_VideoOpen(GFX_VESA_DESIRED, &window_bytes, &vga_dac_type);
 	if (status < 0){
 		if (GFX_VERBOSE){
-			printf("%s.%d\t gfx_Init() Error, Unable to complete gfx initialisation [VESA mode lookup]\n", __FILE__, __LINE__);	
+			printf("%s.%d\t gfx_Init() Error, Unable to complete gfx initialisation [VESA mode %xh]\n", __FILE__, __LINE__, GFX_VESA_DESIRED);	
 		}
-		free(vbeinfo);
-		free(vesamodeinfo);
 		return -1;	
 	} else {	
 		if (GFX_VERBOSE){
-			printf("%s.%d\t gfx_Init() Retrieved VESA mode details %xh\n", __FILE__, __LINE__, GFX_VESA_DESIRED);	
+			printf("%s.%d\t gfx_Init() Set VESA mode %xh, VGA DAC %dbpp\n", __FILE__, __LINE__, GFX_VESA_DESIRED, vga_dac_type);	
 		}
 	}
 	
-	// Set mode GFX_VESA_DESIRED
-	status = vesa_SetMode(GFX_VESA_DESIRED);
-	if (status < 0){
-		if (GFX_VERBOSE){
-			printf("%s.%d\t gfx_Init() Error, Unable to complete gfx initialisation [VESA set mode failed]\n", __FILE__, __LINE__);	
-		}
-		free(vbeinfo);
-		free(vesamodeinfo);
-		return -1;	
-	} else {	
-		if (GFX_VERBOSE){
-			printf("%s.%d\t gfx_Init() Set VESA mode %xh\n", __FILE__, __LINE__, GFX_VESA_DESIRED);	
-		}
-	}
-	
-	// Set VGA DAC type
-	if (vbeinfo->capabilities & 0x01){
-		if (GFX_VERBOSE){
-			printf("%s.%d\t gfx_Init() Trying to switch VGA DAC to %dbpp\n", __FILE__, __LINE__, VGA_PALETTE_8BPP);	
-		}
-		
-		// DAC is programmable - we need to try to switch it to 8bit mode
-		status = vesa_SetDAC(VGA_PALETTE_8BPP);
-		if (status < 0){
-			if (GFX_VERBOSE){
-				printf("%s.%d\t gfx_Init() Unable to switch VGA DAC, defaulting to %dbpp\n", __FILE__, __LINE__, VGA_PALETTE_DEFAULT);	
-			}
-			vga_dac_type = VGA_PALETTE_6BPP;
-		} else {
-			status = vesa_GetDAC(VGA_PALETTE_8BPP);
-			if (status < 0){
-				// Yes, switched to 8bit mode
-				if (GFX_VERBOSE){
-					printf("%s.%d\t gfx_Init() VGA DAC now in %dbpp\n", __FILE__, __LINE__, VGA_PALETTE_8BPP);	
-				}
-				vga_dac_type = VGA_PALETTE_8BPP;
-			} else {
-				// Switching failed, assume 6bpp
-				if (GFX_VERBOSE){
-					printf("%s.%d\t gfx_Init() Warning, VGA DAC not in desired mode, defaulting to %dbpp\n", __FILE__, __LINE__, VGA_PALETTE_6BPP);	
-				}
-				vga_dac_type = VGA_PALETTE_6BPP;
-			}
-		}
-	} else {
-		// DAC is NON-programmable. Palette entries need to be truncated to 6bpp.
-		//if (GFX_VERBOSE){
-		//	printf("%s.%d\t gfx_Init() VESA BIOS indicates VGA DAC is fixed at 6bpp\n", __FILE__, __LINE__);
-		//}
-		//vga_dac_type = VGA_PALETTE_6BPP;
-		status = vesa_SetDAC(VGA_PALETTE_8BPP);
-	}
-	
 	// We've set a new video mode, so recalculate
 	// the window_x_max and window_y_max values
-	// as well as derive the VGA segment address for
-	// the window and the number of bytes in a video window
-	vga_segment = vesamodeinfo->WinASegment;
-	window_bytes = (long int) vesamodeinfo->WinSize * 1024;
+	// from the number of bytes in a video window
 	window_x_max = (window_bytes - 1) % GFX_COLS;
 	window_y_max = (window_bytes - 1) / GFX_COLS;
 	window_bytes_t = (double) ((long int) GFX_COLS * (long int) GFX_ROWS) / window_bytes;
 	windows_in_use = ceil(window_bytes_t);
 	
 	if (GFX_VERBOSE){
-		printf("%s.%d\t gfx_Init() VESA memory window segment address: %xh\n", __FILE__, __LINE__, vga_segment);
 		printf("%s.%d\t gfx_Init() VESA memory window size: %ld bytes (at %d bytes/pixel)\n", __FILE__, __LINE__, window_bytes, GFX_PIXEL_SIZE);
 		printf("%s.%d\t gfx_Init() VESA memory window is: %ld\n", __FILE__, __LINE__, window_x_max);
 		printf("%s.%d\t gfx_Init() VESA memory window rows: %ld\n", __FILE__, __LINE__, window_y_max);
@@ -184,11 +95,15 @@ int gfx_Init(){
 	gfx_Clear();
 	gfx_Flip();
 	
-	free(vbeinfo);
-	free(vesamodeinfo);
 	return 0;
 }
         
+long int gfx_BufferBytes(){
+	// Returns the size of the local graphics buffer
+	
+	return (long int) sizeof(vram_buffer);
+}
+
 int gfx_CheckMode(){
 	// Check if a given SVGA/VESA mode is available
 	
@@ -209,7 +124,7 @@ void gfx_Close(){
 	if (GFX_VERBOSE){
 		printf("%s.%d\t gfx_Close() Restoring text mode\n", __FILE__, __LINE__);	
 	}
-	vesa_SetMode(GFX_VESA_TEXT);
+	platform_VideoClose(GFX_VESA_TEXT);
 }
 
 void gfx_Clear(){
@@ -221,6 +136,61 @@ void gfx_Clear(){
 	
 	// Set local vram_buffer to empty
 	memset(vram_buffer, PALETTE_UI_BLACK, sizeof(vram_buffer));	
+	gfx_Dirty(0, 0, GFX_COLS - 1, GFX_ROWS - 1);
+}
+
+void gfx_Dirty(int x1, int y1, int x2, int y2){
+	// Mark a rectangle of the local vram buffer as drawn to, so that the next
+	// flip copies it. Coordinates are inclusive and clipped to the screen.
+	
+	int row;
+	int temp;
+	
+	if (y1 > y2){
+		temp = y1;
+		y1 = y2;
+		y2 = temp;
+	}
+	if (x1 > x2){
+		temp = x1;
+		x1 = x2;
+		x2 = temp;
+	}
+	if (x1 < 0){
+		x1 = 0;
+	}
+	if (y1 < 0){
+		y1 = 0;
+	}
+	if (x2 >= GFX_COLS){
+		x2 = GFX_COLS - 1;
+	}
+	if (y2 >= GFX_ROWS){
+		y2 = GFX_ROWS - 1;
+	}
+	if ((x1 > x2) || (y1 > y2)){
+		return;
+	}
+	
+	for(row = y1; row <= y2; row++){
+		if (dirty_end[row] == 0){
+			dirty_start[row] = x1;
+			dirty_end[row] = x2 + 1;
+		} else {
+			if (x1 < dirty_start[row]){
+				dirty_start[row] = x1;
+			}
+			if ((x2 + 1) > dirty_end[row]){
+				dirty_end[row] = x2 + 1;
+			}
+		}
+	}
+	if (y1 < dirty_first){
+		dirty_first = y1;
+	}
+	if (y2 > dirty_last){
+		dirty_last = y2;
+	}
 }
 
 void gfx_TextOn(){
@@ -237,45 +207,77 @@ void gfx_TextOff(){
 	}
 }
 
-void gfx_Flip(){
-	// Copy a buffer of GFX_ROWS * GFX_COLS bytes to
-	// the active VRAM framebuffer for display.
+static void gfx_FlipSpan(long int start, long int end){
+	// Copy one run of the local vram buffer, from start up to but not including end,
+	// to the framebuffer; split wherever it crosses into the next video memory window
 	
 	unsigned short int window;
-	long int left;
-	
-	// Set the vram pointer to the start of the buffer
-	vram = vram_buffer;
+	long int offset;
+	long int bytes;
 	
-	left = (long int) VRAM_END;
-	
-	// for each window in the number of windows for this video mode
-	for(window = 0; window < windows_in_use; window++ ){
-		
-		// set new window to be active
-		vesa_SetWindow(window);
-		
-		// copy the block of pixels for this memory window
-		if (left > window_bytes){
-			if (GFX_VERBOSE){
-				printf("%s.%d\t gfx_Flip() Copying %ld bytes to window %d\n", __FILE__, __LINE__, window_bytes, window);
-			}
-			_fmemcpy(VGA, vram, window_bytes - 1);
-			
-			left -= (window_bytes - 1);
+	while (start < end){
+		window = (unsigned short int) (start / window_bytes);
+		offset = start % window_bytes;
+		bytes = end - start;
+		if (bytes > (window_bytes - offset)){
+			bytes = window_bytes - offset;
+		}
+		if (GFX_VERBOSE){
+			printf("%s.%d\t gfx_Flip() Copying %ld bytes to window %d offset %ld\n", __FILE__, __LINE__, bytes, window, offset);
+		}
+		platform_VideoWrite(window, (unsigned int) offset, vram_buffer + start, bytes);
+		flip_bytes += bytes;
+		start += bytes;
+	}
+}
+
+void gfx_Flip(){
+	// Copy everything drawn to the local vram buffer since the last flip to the active
+	// VRAM framebuffer for display. Only the dirty part of each row is copied, and only
+	// the memory windows holding them are mapped in. Rows next to each other are copied
+	// as one run when the gap between them is small, so a full width region is a single
+	// copy for each window it covers.
+	
+	int row;
+	long int start;
+	long int end;
+	long int span_start;
+	long int span_end;
+	
+	span_start = -1;
+	span_end = -1;
+	for(row = dirty_first; row <= dirty_last; row++){
+		if (dirty_end[row] == 0){
+			continue;
+		}
+		start = ((long int) row * GFX_ROW_SIZE) + dirty_start[row];
+		end = ((long int) row * GFX_ROW_SIZE) + dirty_end[row];
+		if ((span_start >= 0) && ((start - span_end) <= GFX_DIRTY_GAP)){
+			span_end = end;
 		} else {
-			if (GFX_VERBOSE){
-				printf("%s.%d\t gfx_Flip() Copying remaining %ld bytes to window %d\n", __FILE__, __LINE__, left, window);
+			if (span_start >= 0){
+				gfx_FlipSpan(span_start, span_end);
 			}
-			_fmemcpy(VGA, vram, left);
+			span_start = start;
+			span_end = end;
 		}
-		
-		// Increment the pointer to the vram buffer by the size of one video window
-		vram += (long int) (window_bytes);
-	};
+		dirty_end[row] = 0;
+	}
+	if (span_start >= 0){
+		gfx_FlipSpan(span_start, span_end);
+	}
+	dirty_first = GFX_ROWS;
+	dirty_last = -1;
+}
+
+unsigned long gfx_FlipBytes(){
+	// Returns the number of bytes copied to video memory since the last call, and starts counting again
 	
-	// Reset vram buffer pointer position
-	vram = vram_buffer;
+	unsigned long bytes;
+	
+	bytes = flip_bytes;
+	flip_bytes = 0;
+	return bytes;
 }
 
 long int gfx_GetXYaddr(unsigned short int x, unsigned short int y){
@@ -291,7 +293,7 @@ long int gfx_GetXYaddr(unsigned short int x, unsigned short int y){
 	//	printf("%s.%d\t Mapping X:%d Y:%d\n", __FILE__, __LINE__, x, y);
 	//}
 	
-	if ((VRAM_START + addr) > VRAM_END){
+	if ((VRAM_START + addr) >= VRAM_END){
 		if (GFX_VERBOSE){
 			printf("%s.%d\t gfx_GetXYaddr() XY coords beyond VRAM buffer end [ %ld > %ld]\n", __FILE__, __LINE__, addr, VRAM_END);
 		}
@@ -327,6 +329,7 @@ int gfx_Bitmap(int x, int y, bmpdata_t *bmpdata){
 	if (GFX_VERBOSE){
 		printf("%s.%d\t gfx_Bitmap() Copy %dx%d bitmap to X:%d Y:%d\n", __FILE__, __LINE__, bmpdata->width, bmpdata->height, x, y);
 	}
+	gfx_Dirty(x, y, x + bmpdata->width - 1, y + bmpdata->height - 1);
 	
 	// Negative X values start offscreen at the left
 	if (x < 0){
@@ -526,19 +529,20 @@ int gfx_BitmapAsync(int x, int y, bmpdata_t *bmpdata, FILE *bmpfile, bmpstate_t
 		}
 	}
 	
-	// Get coordinates
-	new_y = y + bmpstate->rows_remaining;
+	// Get coordinates; rows are stored bottom-up, so the first row read is the last one drawn
+	new_y = y + bmpstate->rows_remaining - 1;
 	start_addr = gfx_GetXYaddr(x, new_y);
 	
-	// Set starting pixel address
-	vram = vram_buffer + start_addr;
-	
 	if (remap_palette){
 		pal_BMPState2Palette(bmpdata, bmpstate, reserved_palette);
 	}
 	
-	// Copy this single line of pixels to the video buffer
-	memcpy(vram, bmpstate->pixels, bmpstate->width_bytes);
+	// Copy this single line of pixels to the video buffer, unless it is offscreen
+	if (start_addr >= 0){
+		vram = vram_buffer + start_addr;
+		memcpy(vram, bmpstate->pixels, bmpstate->width_bytes);
+		gfx_Dirty(x, new_y, x + bmpdata->width - 1, new_y);
+	}
 	
 	bmpstate->rows_remaining--;
 	
@@ -660,6 +664,15 @@ int gfx_Box(int x1, int y1, int x2, int y2, unsigned char palette){
 	// Set starting pixel address
 	vram = vram_buffer + start_addr;
 	
+	// The sides and bottom are drawn starting one pixel to the left of x1,
+	// which from the left edge of the screen is the end of the row above,
+	// and the bottom is always at least one row below the top
+	if (x1 > 0){
+		gfx_Dirty(x1 - 1, y1, x2, (y2 > y1) ? y2 : y1 + 1);
+	} else {
+		gfx_Dirty(0, y1, GFX_COLS - 1, (y2 > y1) ? y2 : y1 + 1);
+	}
+	
 	// Step to next row in vram
 	step = (GFX_COLS - x2) + x1;
 	
@@ -738,6 +751,7 @@ int gfx_BoxFill(int x1, int y1, int x2, int y2, unsigned char palette){
 	}
 	// Set starting pixel address
 	vram = vram_buffer + start_addr;
+	gfx_Dirty(x1, y1, x2, y2);
 	
 	// Step to next row in vram
 	step = (GFX_COLS - x2) + (x1 - 1);
@@ -801,6 +815,7 @@ int gfx_BoxFillTranslucent(int x1, int y1, int x2, int y2, unsigned char palette
 	}
 	// Set starting pixel address
 	vram = vram_buffer + start_addr;
+	gfx_Dirty(x1, y1, x2, y2);
 	
 	// Step to next row in vram
 	step = (GFX_COLS - x2) + (x1 - 1);
@@ -857,6 +872,7 @@ int gfx_Puts(int x, int y, fontdata_t *fontdata, char *c){
 	
 	// Reposition write position
 	vram = vram_buffer + start_offset;
+	gfx_Dirty(x, y, x + ((int) strlen(c) * fontdata->width) - 1, y + fontdata->height);
 	
 	//if (GFX_VERBOSE){
 	//	printf("%s.%d\t gfx_Puts() Copying bitmap to vram offset %d\n", __FILE__, __LINE__, vram);
@@ -41,6 +41,7 @@
 
 #define VRAM_START					0		// Relative start offset into the local memory buffer
 #define VRAM_END						256000	// End of the local memory buffer, should be GFX_ROWS * GFX_COLS * GFX_PIXEL_SIZE
+#define GFX_DIRTY_GAP				64		// Dirty rows closer than this many bytes apart are flipped as a single copy
 
 /* **************************** */
 /* Function prototypes */
@@ -55,6 +56,9 @@ int			gfx_BoxFillTranslucent(int x1, int y1, int x2, int y2, unsigned char palet
 void			gfx_Clear();
 void			gfx_Close();
 void			gfx_Flip();
+unsigned long	gfx_FlipBytes();
+long int		gfx_BufferBytes();
+void			gfx_Dirty(int x1, int y1, int x2, int y2);
 long int		gfx_GetXYaddr(unsigned short int x, unsigned short int y);
 int			gfx_Init();
 int 			gfx_Puts(int x, int y, fontdata_t *fontdata, char *c);
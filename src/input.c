@@ -16,10 +16,9 @@
 */
 
 #include <stdio.h>
-#include <dos.h>
-#include <conio.h>
 
 #include "input.h"
+#include "platform.h"
 
 int input_get(){
 	// Read joystick or keyboard input and return directions or buttons pressed
@@ -27,12 +26,41 @@ int input_get(){
 	int k;
 	
 	// Delay loop
-	delay(KB_DELAY);
+	platform_Delay(KB_DELAY);
 	
-	if (kbhit()){
-		k = getch();
+	if (platform_KeyHit()){
+		k = platform_KeyGet();
 		if (k == 0){
-			k = getch();
+			// Extended keys; the codes of these overlap with
+			// upper case letters, so are kept separate. The
+			// commands are on function keys, so that every
+			// printable key can be used to type a name.
+			k = platform_KeyGet();
+			switch(k){
+				case(input_up):
+					return input_up;
+				case(input_down):
+					return input_down;
+				case(input_left):
+					return input_left;
+				case(input_right):
+					return input_right;
+				case(input_scroll_up):
+					return input_scroll_up;
+				case(input_scroll_down):
+					return input_scroll_down;
+				case(input_help):
+					return input_help;
+				case(input_filter):
+					return input_filter;
+				case(input_quit):
+					return input_quit;
+				default:
+					if (INPUT_VERBOSE){
+						printf("Unrecognised input: 0x00 %x\n", k);
+					}
+					return input_none;
+			}
 		}
 		switch(k){
 			case(input_select):
@@ -43,25 +71,15 @@ int input_get(){
 				return input_cancel;
 			case(input_switch):
 				return input_switch;
-			case(input_up):
-				return input_up;
-			case(input_down):
-				return input_down;
-			case(input_left):
-				return input_left;
-			case(input_right):
-				return input_right;
-			case(input_scroll_up):
-				return input_scroll_up;
-			case(input_scroll_down):
-				return input_scroll_down;
-			case(input_quit):
-				return input_quit;
-			case(input_filter):
-				return input_filter;
-			case(input_help):
-				return input_help;
+			case(input_backspace):
+				return input_backspace;
+			case(input_search):
+				return input_search;
 			default:
+				// Anything else printable is used to type names
+				if ((k > 0x20) && (k < 0x7F)){
+					return input_char | k;
+				}
 				if (INPUT_VERBOSE){
 					printf("Unrecognised input: %x\n", k);
 				}
@@ -210,7 +228,7 @@ int input_test(){
 		}
 	}
 	exit = 0;
-	printf("Press q, lowercase\n");
+	printf("Press F10\n");
 	while(exit == 0){
 		user_input = input_get();
 		if (user_input != input_none){
@@ -223,7 +241,7 @@ int input_test(){
 		}
 	}
 	exit = 0;
-	printf("Press f, lowercase\n");
+	printf("Press F2\n");
 	while(exit == 0){
 		user_input = input_get();
 		if (user_input != input_none){
@@ -236,7 +254,7 @@ int input_test(){
 		}
 	}
 	exit = 0;
-	printf("Press h, lowercase\n", input_help);
+	printf("Press F1\n");
 	while(exit == 0){
 		user_input = input_get();
 		if (user_input != input_none){
@@ -30,9 +30,12 @@
 #define input_right				0x4D
 #define input_scroll_up			0x49 // Page up
 #define input_scroll_down		0x51 // Page down
-#define input_quit				0x71 // Q == Quit
-#define input_filter				0x66 // F == Filter
-#define input_help				0x68 // H == Help
+#define input_help				0x3B // F1 == Help
+#define input_filter				0x3C // F2 == Filter
+#define input_quit				0x44 // F10 == Quit
+#define input_backspace			0x08 // Backspace
+#define input_search				0x2F // / == Search
+#define input_char				0x100 // OR'ed with any other printable character, for typing names
 
 // Function prototypes
 int	input_get();
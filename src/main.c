@@ -18,8 +18,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <conio.h>
-#include <i86.h>
 #include <time.h>
 
 #ifndef __HAS_DATA
@@ -51,7 +49,13 @@
 #include "ui.h"
 #include "fstools.h"
 #include "filter.h"
+#include "query.h"
+#include "search.h"
+#include "names.h"
 #include "timers.h"
+#include "cache.h"
+#include "memory.h"
+#include "platform.h"
 
 int main() {
 	/* Lets get this show on the road!!! */
@@ -69,12 +73,17 @@ int main() {
 	int progress;							// Progress bar percentage
 	int super;								// Supervisor mode flag
 	int found, found_tmp;					// Number of gamedirs/games found
+	int rescanned;							// Number of search paths which could not be loaded from the index
 	int verbose;								// Controls output of additional logging/text
 	int status;								// Generic function return status variable
-	char msg[64];							// Message buffer
+	char msg[MAX_IMAGEPATH_SIZE];			// Message buffer, big enough for a search path or the path of some artwork
+	char game_path[MAX_GAMEPATH_SIZE];		// Full path of a game, put together by getGamePath()
+	char search_text[SEARCH_TEXT_SIZE] = "";	// Text typed into the search pane
+	int search_len = 0;						// Length of the text typed into the search pane
 	clock_t start_time, end_time, end_time2;	// Performance counters, set 1
 	clock_t t1, t2;							// Performance counters, set 2
 	clock_t last;							// Timer for detecting last user input
+	unsigned long flip_bytes;				// Bytes copied to video memory by each pass of the main loop
 	FILE *screenshot_file;					// File handle for artwork bitmap reading
 	FILE *savefile;							// File handle for saving game list data
 	state_t *state = NULL;					// Current state of the UI, including selected game, page, etc
@@ -82,12 +91,16 @@ int main() {
 	bmpstate_t *screenshot_bmp_state = NULL;	// State buffer for reading artwork line-by-line
 	gamedata_t *gamedata = NULL;				// An initial gamedata record for the first game directory we read
 	gamedata_t *gamedata_head = NULL;		// Constant pointer to the start of the gamedata list
+	gamedata_t *gamedata_list = NULL;		// Empty record ahead of the first game, which stays put when the list is re-sorted
+	gamedata_t *gamedata_tail = NULL;		// Last record in the gamedata list, so each search path is appended without walking the list
+	gamedata_t *previous = NULL;				// Games from the previous run for a search path that is being scraped again
 	launchdat_t *launchdat = NULL;			// When a single game is selected, we attempt to load its metadata file from disk
 	launchdat_t *filterdat = NULL;			// Used when loading metadata files to filter games
 	imagefile_t *imagefile = NULL;			// When a single game is selected, we attempt to load a list of the screenshots from metadata
 	//imagefile_t *imagefile_head = NULL;		// Constant pointer to the start of the game screenshot list
 	gamedir_t *gamedir = NULL;				// List of the game search directories, as defined in our INIFILE
 	config_t *config = NULL;					// Configuration data as defined in our INIFILE		
+	arena_stats_t arena_stats;				// How much of the scan arena is used and wasted
 	screenshot_file = NULL;					// Artwork file has not been set yet
 	has_screenshot = 0;						// No screenshots unless detected
 	has_launchdat = 0;						// No launchdat metadata unless loaded
@@ -99,6 +112,7 @@ int main() {
 	scrape_dirs = 0;							// Default to 0 directories found
 	progress = 0;							// Default to 0 progress bar size
 	found = found_tmp = 0;					// Counter of the number of found directories/gamedata items
+	rescanned = 0;							// No search paths scraped yet
 	verbose = 1;								// Initial debug/verbose setting; overidden from INIFILE, if set
 	
 	printf("%s starting...\n", MY_NAME);
@@ -107,7 +121,8 @@ int main() {
 	/* Create a new empty gamedata entry */
 	/* ************************************** */
 	gamedata = (gamedata_t *) malloc(sizeof(gamedata_t));
-	gamedata->next = NULL;
+	memset(gamedata, 0, sizeof(gamedata_t));
+	gamedata->name = gamedata->leaf;
 	
 	/* ************************************** */
 	/* Parse the gamedirs that are set */
@@ -134,17 +149,17 @@ int main() {
 	// Launchdat metadata structure
 	launchdat = (launchdat_t *) malloc(sizeof(launchdat_t));
 	filterdat = (launchdat_t *) malloc(sizeof(launchdat_t));
-	launchdat->hardware = (hwdata_t *) malloc(sizeof(hwdata_t));
-	filterdat->hardware = (hwdata_t *) malloc(sizeof(hwdata_t));
 	
 	/* ************************************** */
 	/* Create an instance of the UI state data */
 	/* ************************************** */
 	state = (state_t *) malloc(sizeof(state_t));
+	state->selected_list = NULL;		// Sized to fit each new selection by query_SelectionSize()
+	state->selected_size = 0;
 	state->selected_max = 0;			// Total amount of items in current filtered selection
 	state->selected_page = 1;		// Default to first page of selected games 
 	state->selected_line = 0;		// Default to first line selected
-	state->total_pages = 0;			// Total number of pages of selected games (selected_max / ui_browser_max_lines)
+	state->total_pages = 1;			// Total number of pages of selected games (selected_max / ui_browser_max_lines)
 	state->selected_gameid = -1;		// Current selected game
 	state->has_images = 0;			
 	state->has_launchdat = 0;
@@ -152,7 +167,15 @@ int main() {
 	state->selected_start = 0;
 	state->selected_filter_string = 0;
 	state->active_pane = BROWSER_PANE;
-	for(i =0; i <SELECTION_LIST_SIZE; i++){
+	state->filter_strings = NULL;		// Sized to fit each new list of keywords by filter_StringsSize()
+	state->filter_strings_selected = NULL;
+	state->filter_strings_count = NULL;
+	state->filter_strings_size = 0;
+	state->available_filter_strings = 0;
+	state->available_filter_pages = 0;
+	state->current_filter_page = 0;
+	query_SelectionSize(state, 0);
+	for(i =0; i <state->selected_size; i++){
 		state->selected_list[i] = -1;
 	}
 	
@@ -216,6 +239,10 @@ int main() {
 	start_time = clock();
 	status = gfx_Init();
 	end_time = clock();
+	if (status == 0){
+		// Printing to the screen would now draw over it, so timings go to a log until it is closed
+		timers_Log(config->timers);
+	}
 	timers_Print(start_time, end_time, "GFX Init", config->timers);
 	if (status != 0){
 		printf("%s.%d\t Error unable to initialise graphic mode!!!\n", __FILE__, __LINE__);
@@ -235,6 +262,7 @@ int main() {
 	} else {
 		printf("%s.%d\t Valid graphics mode found\n", __FILE__, __LINE__);	
 	}
+	memory_Report("GFX Init", state, config->timers);
 	
 	// Do basic UI initialisation
 	start_time = clock();
@@ -251,6 +279,7 @@ int main() {
 	gfx_Flip();
 	ui_DrawSplashProgress(1, progress);
 	gfx_Flip();
+	memory_Report("UI Init", state, config->timers);
 	
 	// ======================
 	// Load UI font data
@@ -269,6 +298,7 @@ int main() {
 	progress += splash_progress_chunk_size;
 	ui_DrawSplashProgress(0, progress);
 	gfx_Flip();
+	memory_Report("Font Loading", state, config->timers);
 	
 	// ======================
 	// Load UI asset data
@@ -289,6 +319,7 @@ int main() {
 	ui_DrawSplashProgress(0, progress);
 	ui_ProgressMessage("All UI assets loaded!");
 	gfx_Flip();
+	memory_Report("UI Asset Loading", state, config->timers);
 		
 	// ======================
 	// Apply any settings from the config file
@@ -334,6 +365,7 @@ int main() {
 	ui_DrawSplashProgress(0, progress);
 	ui_ProgressMessage("Configuration applied!");
 	gfx_Flip();
+	memory_Report("Configuration", state, config->timers);
 	
 	// ======================
 	//
@@ -357,6 +389,18 @@ int main() {
 	
 	gamedir = config->dir;
 	start_time = clock();
+	previous = (gamedata_t *) malloc(sizeof(gamedata_t));
+	if (previous == NULL){
+		ui_ProgressMessage("ERROR! Unable to allocate memory to scrape games!!!");
+		gfx_Flip();
+		printf("%s.%d\t Unable to allocate memory to scrape games\n", __FILE__, __LINE__);
+		ui_Close();
+		gfx_Close();
+		return -1;
+	}
+	previous->next = NULL;
+	gamedata_tail = gamedata;
+	cache_Open(config);
 	while (gamedir->next != NULL){
 		gamedir = gamedir->next;
 		// ======================
@@ -365,18 +409,62 @@ int main() {
 		//
 		// ======================               
 		found_tmp = 0;
-		found_tmp = findDirs(gamedir->path, gamedata, found, config, launchdat);
+		found_tmp = cache_LoadDir(gamedir, gamedata_tail, found, config);
+		if (found_tmp == CACHE_ERR){
+			// Not in the index, or changed since it was saved, so scrape it
+			// again; carrying over any game directories that are unchanged
+			previous->next = NULL;
+			cache_LoadPrevious(gamedir, previous);
+			found_tmp = findDirs(gamedir, gamedata_tail, found, config, launchdat, previous);
+			if (previous->next != NULL){
+				// Anything left over was removed or has changed
+				removeGamedata(previous->next);
+				previous->next = NULL;
+			}
+			rescanned++;
+			sprintf(msg, "Found %d games in %s", found_tmp, gamedir->path);
+		} else {
+			sprintf(msg, "Loaded %d games in %s", found_tmp, gamedir->path);
+		}
 		found = found + found_tmp;
-		sprintf(msg, "Found %d games in %s", found_tmp, gamedir->path);
+		gamedata_tail = getLastGamedata(gamedata_tail);
 		ui_ProgressMessage(msg);
 		progress += scrape_progress_chunk_size;
 		ui_DrawSplashProgress(0, progress);
 		gfx_Flip();		
 	}
+	cache_Close();
+	free(previous);
 	end_time = clock();
 	timers_Print(start_time, end_time, "Game Scraping", config->timers);
+	if (config->timers){
+		getArenaStats(&arena_stats);
+		printf("%s.%d\t %-30s: %5lu bytes used, %lu wasted, %lu spare, %lu recycled in %u blocks\n", __FILE__, __LINE__, "Scan Arena", arena_stats.used, arena_stats.wasted, arena_stats.spare, arena_stats.recycled, arena_stats.blocks);
+	}
 	ui_ProgressMessage("Scraped!");
 	gfx_Flip();
+	memory_Report("Game Scraping", state, config->timers);
+	
+	// ======================
+	//
+	// Update the game index if any search path had to be scraped, even
+	// if nothing was found, so it isn't scraped again on the next start
+	//
+	// ======================
+	if (rescanned > 0){
+		sprintf(msg, "Saving game index to %s", INDEXFILE);
+		ui_ProgressMessage(msg);
+		gfx_Flip();
+		start_time = clock();
+		status = cache_Save(config, gamedata);
+		if (status != CACHE_OK){
+			if (config->verbose){
+				printf("%s.%d	 Warning: Unable to save game index to %s\n", __FILE__, __LINE__, INDEXFILE);
+			}
+		}
+		end_time = clock();
+		timers_Print(start_time, end_time, "Index Saving", config->timers);
+	}
 	
 	// ========================
 	//
@@ -385,7 +473,7 @@ int main() {
 	// ========================
 	if (found < 1){
 		free(config);
-		free(gamedir);
+		freeGamedata();
 		free(gamedata);
 		ui_ProgressMessage("ERROR! No game folders found!!!");
 		gfx_Flip();
@@ -420,10 +508,20 @@ int main() {
 	sortGamedata(gamedata, config->verbose);
 	end_time = clock();
 	timers_Print(start_time, end_time, "Game Sorting", config->timers);
+	start_time = clock();
+	status = indexGamedata(gamedata);
+	if (status != 0){
+		if (config->verbose){
+			printf("%s.%d\t Warning: Unable to index game IDs, falling back to searching the list\n", __FILE__, __LINE__);
+		}
+	}
+	end_time = clock();
+	timers_Print(start_time, end_time, "Game Indexing", config->timers);
 	progress += splash_progress_chunk_size;
 	ui_DrawSplashProgress(0, progress);
 	ui_ProgressMessage("Sorted!");
 	gfx_Flip();
+	memory_Report("Game Sorting", state, config->timers);
 	
 	// ======================
 	// 
@@ -434,6 +532,7 @@ int main() {
 	gfx_Flip();
 	
 	// Select the first game
+	gamedata_list = gamedata;
 	if (gamedata->next != NULL){
 		gamedata = gamedata->next;
 	}
@@ -489,11 +588,11 @@ int main() {
 			if (savefile == NULL){
 					sprintf(msg, "Warning: Unable to create save file. Press any key.");
 					ui_ProgressMessage(msg);
-					getch();
+					platform_KeyGet();
 			} else {
 					gamedata_head = gamedata;
 					while(gamedata->next != NULL){
-							fputs(gamedata->path, savefile);
+							fputs(getGamePath(gamedata, game_path), savefile);
 							fputs("\n", savefile);
 							gamedata = gamedata->next;
 					}
@@ -507,6 +606,7 @@ int main() {
 	}
 	ui_DrawSplashProgress(0, splash_progress_complete);
 	gfx_Flip();
+	memory_Report("Selection List", state, config->timers);
 	
 	
 	// ======================
@@ -548,7 +648,7 @@ int main() {
 	if (status != UI_OK){
 		printf("ERROR! Unable to draw info pane widgets!\n");
 		free(config);
-		free(gamedir);
+		freeGamedata();
 		free(gamedata);
 		return status;
 	}
@@ -561,7 +661,7 @@ int main() {
 	if (status != UI_OK){
 		printf("ERROR! Unable to update info pane contents!\n");
 		free(config);
-		free(gamedir);
+		freeGamedata();
 		free(gamedata);
 		return status;
 	}
@@ -573,6 +673,8 @@ int main() {
 	gfx_Flip();	
 	end_time = clock();
 	timers_Print(start_time, end_time, "Flip GFX buffer", config->timers);
+	timers_PrintBytes(gfx_FlipBytes(), "Flip bytes (loading)", config->timers);
+	memory_Report("Main UI", state, config->timers);
 	
 	// ======================
 	//
@@ -873,7 +975,7 @@ int main() {
 					break;
 				case(input_scroll_down):
 					// Page down key - move to previous PAGE of filter keywords
-					if (state->current_filter_page < (state->available_filter_pages - 1)){
+					if ((state->current_filter_page + 1) < state->available_filter_pages){
 						if (config->verbose){
 							printf("%s.%d\t Toggle filter page down\n", __FILE__, __LINE__);	
 						}
@@ -896,6 +998,8 @@ int main() {
 							printf("%s.%d\t Toggle filter selection on/off\n", __FILE__, __LINE__);	
 						}
 						state->filter_strings_selected[state->selected_filter_string] = !(state->filter_strings_selected[state->selected_filter_string]);
+						// Counts shown against each tech spec depend on what else is selected
+						filter_CountTechSpecs(state, gamedata, filterdat);
 						ui_DrawFilterPopup(state, 0, 0, 1);
 						gfx_Flip();
 					} else {
@@ -921,6 +1025,7 @@ int main() {
 					gfx_Flip();
 					break;
 				case(input_select):
+					status = FILTER_OK;
 					if (state->selected_filter == FILTER_GENRE){
 						// Now apply the chosen filter
 						status = filter_Genre(state, gamedata, filterdat);
@@ -958,6 +1063,13 @@ int main() {
 					ui_UpdateBrowserPaneStatus(state);
 					gfx_Flip();
 					ui_DisplayArtwork(screenshot_file, screenshot_bmp, screenshot_bmp_state, state, imagefile);
+					if (status != FILTER_OK){
+						// The previous selection is still shown, so say why it didn't change
+						ui_StatusMessage("Not enough memory to apply that filter, the list is unchanged");
+						if (config->verbose){
+							printf("%s.%d\t Unable to apply filter, keeping the previous selection\n", __FILE__, __LINE__);
+						}
+					}
 					gfx_Flip();
 					user_input = input_get();
 					break;
@@ -986,12 +1098,91 @@ int main() {
 			}
 		}
 		
+		// ==================================================
+		//
+		// Search box, narrowing the browser list to games
+		// with the typed text anywhere in their name as
+		// each key is pressed.
+		//
+		// ==================================================
+		if (active_pane == SEARCH_PANE){
+			
+			// Command keys are just characters while typing
+			if (user_input == input_search){
+				user_input = input_char | '/';
+			}
+			if (user_input == input_toggle){
+				user_input = input_char | ' ';
+			}
+			
+			switch(user_input){
+				case(input_select):
+				case(input_cancel):
+					if ((user_input == input_cancel) || (state->selected_max == 0)){
+						// Back to the list from before the search
+						search_Cancel(state, gamedata);
+					}
+					if (config->verbose){
+						printf("%s.%d\t Closing search box\n", __FILE__, __LINE__);	
+					}
+					active_pane = BROWSER_PANE;
+					// exit and redraw main window
+					ui_DrawMainWindow();
+					ui_UpdateBrowserPane(state, gamedata);
+					gfx_Flip();
+					ui_DrawInfoBox();
+					ui_ReselectCurrentGame(state);
+					ui_UpdateInfoPane(state, gamedata, launchdat);
+					ui_UpdateBrowserPaneStatus(state);
+					gfx_Flip();
+					ui_DisplayArtwork(screenshot_file, screenshot_bmp, screenshot_bmp_state, state, imagefile);
+					gfx_Flip();
+					user_input = input_get();
+					break;
+				case(input_backspace):
+					if (search_len > 0){
+						search_len--;
+						search_text[search_len] = '\0';
+						start_time = clock();
+						search_Substring(state, gamedata, search_text);
+						ui_UpdateBrowserPane(state, gamedata);
+						ui_UpdateBrowserPaneStatus(state);
+						ui_DrawSearchPopup(state, search_text);
+						gfx_Flip();
+						end_time = clock();
+						timers_Print(start_time, end_time, "Search", config->timers);
+					}
+					break;
+				default:
+					if ((user_input & input_char) && (search_len < (SEARCH_TEXT_SIZE - 1))){
+						search_text[search_len] = user_input & 0xFF;
+						search_len++;
+						search_text[search_len] = '\0';
+						start_time = clock();
+						search_Substring(state, gamedata, search_text);
+						ui_UpdateBrowserPane(state, gamedata);
+						ui_UpdateBrowserPaneStatus(state);
+						ui_DrawSearchPopup(state, search_text);
+						gfx_Flip();
+						end_time = clock();
+						timers_Print(start_time, end_time, "Search", config->timers);
+					}
+					break;
+			}
+		}
+		
 		// ==================================================
 		//
 		// Main browser window, listing all of our games
 		//
 		// ==================================================
 		if (active_pane == BROWSER_PANE){
+			
+			// Any other key ends typing of a name
+			if ((user_input != input_none) && !(user_input & input_char) && (user_input != input_toggle) && (user_input != input_backspace)){
+				search_TypeAheadReset();
+			}
+			
 			switch(user_input){
 				case(input_quit):
 					// Exit the application
@@ -1016,6 +1207,22 @@ int main() {
 					ui_DrawFilterPrePopup(state, 0);
 					gfx_Flip();
 					break;
+				case(input_search):
+					// Show search box
+					if (config->verbose){
+						printf("%s.%d\t Attempting launch search box...\n", __FILE__, __LINE__);	
+					}
+					start_time = clock();
+					if (search_Open(state, gamedata) == SEARCH_OK){
+						active_pane = SEARCH_PANE;
+						search_len = 0;
+						search_text[0] = '\0';
+						ui_DrawSearchPopup(state, search_text);
+						gfx_Flip();
+					}
+					end_time = clock();
+					timers_Print(start_time, end_time, "Search Indexing", config->timers);
+					break;
 				case(input_select):
 					// Start a game or launch a config tool
 					if (state->selected_game->has_dat){
@@ -1102,7 +1309,7 @@ int main() {
 					last = clock();
 					
 					// Down current list by one row
-					if ((state->selected_line == ui_browser_max_lines - 1) || (state->selected_line == (state->selected_max - 1))){
+					if ((state->selected_line == ui_browser_max_lines - 1) || ((((state->selected_page - 1) * ui_browser_max_lines) + state->selected_line + 1) >= state->selected_max)){
 						if (state->selected_page == state->total_pages){
 							// Go to first page
 							state->selected_page = 1;
@@ -1201,7 +1408,36 @@ int main() {
 					end_time = clock();
 					timers_Print(start_time, end_time, "Artwork scroll Right", config->timers);
 					break;
+				case(input_toggle):
+				case(input_backspace):
+					// A space within a name, or deleting the last character typed
+					start_time = clock();
+					if (search_TypeAhead(state, gamedata, (user_input == input_toggle) ? ' ' : '\b') == SEARCH_OK){
+						last = clock();
+						if (state->page_changed == 1){
+							ui_UpdateBrowserPane(state, gamedata);
+							state->page_changed = 0;
+						}
+						ui_UpdateBrowserPaneStatus(state);
+					}
+					end_time = clock();
+					timers_Print(start_time, end_time, "Type-ahead", config->timers);
+					break;
 				default:
+					if (user_input & input_char){
+						// Jump to the first game starting with what has been typed
+						start_time = clock();
+						if (search_TypeAhead(state, gamedata, user_input & 0xFF) == SEARCH_OK){
+							last = clock();
+							if (state->page_changed == 1){
+								ui_UpdateBrowserPane(state, gamedata);
+								state->page_changed = 0;
+							}
+							ui_UpdateBrowserPaneStatus(state);
+						}
+						end_time = clock();
+						timers_Print(start_time, end_time, "Type-ahead", config->timers);
+					}
 					break;
 			}
 			// ===================================================================
@@ -1303,8 +1539,8 @@ int main() {
 								if (config->verbose){
 									printf("%s.%d\t Selected artwork filename [%s]\n", __FILE__, __LINE__, imagefile->filename[imagefile->first]);
 								}
-								sprintf(msg, "%s\\%s", state->selected_game->path, imagefile->filename[imagefile->first]);
-								strncpy(state->selected_image, msg, 65);
+								sprintf(msg, "%s\\%s", getGamePath(state->selected_game, game_path), imagefile->filename[imagefile->first]);
+								strcpy(state->selected_image, msg);
 							}
 						}
 						
@@ -1334,24 +1570,70 @@ int main() {
 				gfx_Flip();
 			}
 		}
+		
+		// ==================================================
+		//
+		// Load real names in the background, while there is
+		// nothing else to do
+		//
+		// ==================================================
+		if ((user_input == input_none) && (active_pane == BROWSER_PANE) && (old_gameid == state->selected_gameid) && names_Pending()){
+			start_time = clock();
+			status = names_Resolve(state, gamedata_list, NAMES_BATCH);
+			if (status > 0){
+				// The first game may have changed
+				gamedata = gamedata_list->next;
+				ui_UpdateBrowserPane(state, gamedata);
+				state->page_changed = 0;
+				ui_UpdateBrowserPaneStatus(state);
+				gfx_Flip();
+				end_time = clock();
+				timers_Print(start_time, end_time, "Load names", config->timers);
+			}
+			if ((names_Pending() == 0) && (names_Loaded() > 0)){
+				// Keep the names, so they don't have to be loaded again next time
+				start_time = clock();
+				status = cache_Save(config, gamedata_list);
+				if (status != CACHE_OK){
+					if (config->verbose){
+						printf("%s.%d	 Warning: Unable to save game index to %s\n", __FILE__, __LINE__, INDEXFILE);
+					}
+				}
+				end_time = clock();
+				timers_Print(start_time, end_time, "Index Saving", config->timers);
+			}
+		}
+		
+		// How much of the screen had to be copied to video memory for this input
+		flip_bytes = gfx_FlipBytes();
+		if (flip_bytes > 0){
+			timers_PrintBytes(flip_bytes, "Flip bytes", config->timers);
+		}
 	}
 	
 	ui_Close();
 	gfx_Close();
+	timers_Log(0);
 	
 	printf("x86Launcher exiting...\n\n");
 	
 	printf("%s.%d\t Deallocating objects\n", __FILE__, __LINE__);
-	removeGamedata(gamedata);
+	search_Free();
+	query_Free();
+	freeGamedata();
 	free(launchdat);	
+	free(state->selected_list);
+	filter_StringsFree(state);
 	
 	printf("%s.%d\t Deallocating open artwork\n", __FILE__, __LINE__);
 	bmp_Destroy(screenshot_bmp);
 	bmp_DestroyState(screenshot_bmp_state);
 	
+	// Artwork and the save file are both closed as soon as they have been used
 	printf("%s.%d\t Closing open files\n", __FILE__, __LINE__);
-	fclose(screenshot_file);
-	fclose(savefile);
+	if (screenshot_file != NULL){
+		fclose(screenshot_file);
+	}
 	
 	printf("\nExited!\n", __FILE__, __LINE__);
 	return 0;
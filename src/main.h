@@ -17,7 +17,8 @@
 
 #define MY_NAME "x86launcher"
 
-#define SELECTION_LIST_SIZE			999 // Maximum number of entries in the game browser
+#define SELECTION_LIST_BLOCK		64		// The game browser list is resized in steps of this many entries
+#define SELECTION_LIST_MAX		32767	// Maximum number of entries in the game browser; keeps the list within one 64KB segment
 
 #define FILTER_NONE		0
 #define FILTER_GENRE		1
@@ -28,17 +29,17 @@
 #define START_MAIN		0
 #define START_ALT		1
 
-#define MAXIMUM_FILTER_STRINGS 200
 #define MAXIMUM_SELECTED_STRINGS 30
 #define MAXIMUM_FILTER_STRINGS_PER_PAGE 33
 #define MAXIMUM_FILTER_STRINGS_PER_COL 11
 
 typedef struct state {
-	unsigned int selected_list[SELECTION_LIST_SIZE];		// A list of game ID's which are currently selected
+	unsigned int *selected_list;			// A list of game ID's which are currently selected, sized by query_SelectionSize()
+	unsigned int selected_size;			// Number of entries allocated for the selected list
 	unsigned int selected_max;			// Number of items in the current selected list
-	unsigned char selected_page;			// Page 'N' of the selected list
+	unsigned int selected_page;			// Page 'N' of the selected list
 	unsigned char selected_line;			// The line in the page indicating the selected game
-	unsigned char total_pages;			// Total number of pages in the selected_list
+	unsigned int total_pages;			// Total number of pages in the selected_list
 	unsigned char active_pane;			// The pane which currently has focus
 	unsigned char selected_start;		// Which start file to launch, 0==start, 1==alt_start
 	unsigned char page_changed;			// Whether we have browsed to a new page or not
@@ -47,18 +48,20 @@ typedef struct state {
 	int selected_filter_string;			// Which filter string is selected for non=multichoice filters
 	
 	unsigned int available_filter_strings; // How many filter strings are currently available
-	unsigned char available_filter_pages;	// How many pages of filter strings are available
-	unsigned char current_filter_page;	// Which page of filter strings is currently selected
+	unsigned int available_filter_pages;	// How many pages of filter strings are available
+	unsigned int current_filter_page;	// Which page of filter strings is currently selected
 	
 	// Info about selected item
 	int selected_gameid;					// Currently selected gameid
 	gamedata_t *selected_game;			// Currently selected gamedata item
 	unsigned char has_launchdat;			// Current game has metadata
 	unsigned char has_images;			// Current game has artwork
-	char selected_image[65];				// path + filename of current artwork
+	char selected_image[MAX_IMAGEPATH_SIZE];	// path + filename of current artwork
 	
-	// Filter list
-	char filter_strings[MAXIMUM_FILTER_STRINGS][MAX_STRING_SIZE];
-	unsigned char filter_strings_selected[MAXIMUM_FILTER_STRINGS]; // 1 or 0 to indicate if the string at this position is selected
+	// Filter list, sized by filter_StringsSize()
+	char **filter_strings;				// Each string points into the keyword dictionary, or at a tech spec label
+	unsigned char *filter_strings_selected; // 1 or 0 to indicate if the string at this position is selected
+	unsigned int *filter_strings_count;	// Number of games matching the string at this position
+	unsigned int filter_strings_size;	// Number of entries allocated in each of the above
 	
 } state_t;
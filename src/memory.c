@@ -0,0 +1,88 @@
+/* memory.c, Memory usage reports for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#ifndef __HAS_MAIN
+#include "main.h"
+#define __HAS_MAIN
+#endif
+#include "filter.h"
+#include "gfx.h"
+#include "memory.h"
+#include "platform.h"
+#include "query.h"
+#include "search.h"
+#include "timers.h"
+#include "ui.h"
+
+static int memory_logged = 0;			// Whether the log has been started for this run
+
+void memory_Sample(state_t *state, memory_report_t *report){
+	// Fill in how much memory is free, and how much each part of the launcher is holding
+	
+	// state: May be NULL before it has been created, the filter state is then left at 0
+	
+	memset(report, 0, sizeof(memory_report_t));
+	platform_HeapInfo(&report->near_free, &report->far_free, &report->largest);
+	report->framebuffer = gfx_BufferBytes();
+	report->font = ui_FontBytes();
+	report->bitmaps = ui_AssetBytes();
+	report->games = getGamedataBytes();
+	report->metadata = getMetadataBytes();
+	if (state != NULL){
+		report->filters = filter_Bytes(state) + query_Bytes(state) + search_Bytes();
+	}
+}
+
+void memory_Report(char *stage, state_t *state, int enabled){
+	// Print a memory report for a stage of loading, and add it to the log. The log is
+	// started afresh by the first report of each run. The report is printed with the
+	// timings, so it goes to the timings log once in graphics mode.
+	
+	memory_report_t report;
+	FILE *log;
+	
+	if (!enabled){
+		return;
+	}
+	
+	memory_Sample(state, &report);
+	fprintf(timers_Out(), "%s.%d\t %-30s: %7lu free, %7lu largest, %6lu near\n", __FILE__, __LINE__, stage, report.far_free, report.largest, report.near_free);
+	fprintf(timers_Out(), "%s.%d\t %-30s: %6lu gfx, %5lu font, %6lu ui, %7lu games, %6lu meta, %6lu filters\n", __FILE__, __LINE__, "", report.framebuffer, report.font, report.bitmaps, report.games, report.metadata, report.filters);
+	
+	if (memory_logged){
+		log = fopen(MEMORY_LOG, "a");
+	} else {
+		log = fopen(MEMORY_LOG, "w");
+	}
+	if (log == NULL){
+		return;
+	}
+	if (!memory_logged){
+		fprintf(log, "%-30s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "Stage", "Near", "Far", "Largest", "Gfx", "Font", "UI", "Games", "Meta", "Filters");
+		memory_logged = 1;
+	}
+	fprintf(log, "%-30s %8lu %8lu %8lu %8lu %8lu %8lu %8lu %8lu %8lu\n", stage, report.near_free, report.far_free, report.largest, report.framebuffer, report.font, report.bitmaps, report.games, report.metadata, report.filters);
+	fclose(log);
+}
@@ -0,0 +1,45 @@
+/* memory.h, Memory usage reports for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#ifndef __HAS_MAIN
+#include "main.h"
+#define __HAS_MAIN
+#endif
+
+// Defaults
+#define MEMORY_LOG			"memory.log"	// Every report is also written here, one line per stage
+
+// Free memory, and what each part of the launcher is holding, at one point in time
+typedef struct memory_report {
+	unsigned long near_free;			// Bytes free in the near heap
+	unsigned long far_free;			// Bytes free in the far heap, and in DOS memory it can still grow into
+	unsigned long largest;			// Largest single block that could still be allocated
+	unsigned long framebuffer;		// Local graphics buffer
+	unsigned long font;				// Font glyphs
+	unsigned long bitmaps;			// UI bitmaps and the main background line buffer
+	unsigned long games;				// Scan arena and gameid index, less the metadata
+	unsigned long metadata;			// Metadata records, keywords and the keyword table
+	unsigned long filters;			// Filter strings, selection list, query bitsets and search index
+} memory_report_t;
+
+// Function prototypes
+void	memory_Sample(state_t *state, memory_report_t *report);
+void	memory_Report(char *stage, state_t *state, int enabled);
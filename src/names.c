@@ -0,0 +1,250 @@
+/* names.c, Background loading of real game names for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#ifndef __HAS_MAIN
+#include "main.h"
+#define __HAS_MAIN
+#endif
+#include "names.h"
+#include "query.h"
+#include "search.h"
+#include "ui.h"
+
+// Games are scraped with their directory names, so the browser can be shown straight
+// away. The real names are then loaded a few at a time while the main loop is idle,
+// walking the games in gameid order.
+static int names_next = 0;				// Gameid of the next game to look at
+static int names_done = 0;				// Every game has been looked at
+static int names_loaded = 0;			// Number of launch.dat files read so far
+static unsigned int names_moved = 0;	// Number of batches which moved games in the sorted list
+
+int names_Pending(){
+	// Returns true while there are games which may still be showing their directory name
+	
+	return (names_done == 0);
+}
+
+int names_Loaded(){
+	// Returns the number of games whose name has been loaded, whether it changed or not
+	
+	return names_loaded;
+}
+
+unsigned int names_Moved(){
+	// Returns how many times games have moved in the sorted list; anything indexed in
+	// sorted order is out of date once this changes
+	
+	return names_moved;
+}
+
+static void names_Select(state_t *state, gamedata_t *gamedata, gamedata_t *game){
+	// Put a renamed game back into the selection list, at its sorted position
+	
+	unsigned int low;
+	unsigned int high;
+	unsigned int mid;
+	
+	// The game was taken out of the list first, so there is always room for it
+	if (state->selected_max >= state->selected_size){
+		return;
+	}
+	
+	// First position whose name sorts after the game
+	low = 0;
+	high = state->selected_max;
+	while (low < high){
+		mid = low + ((high - low) / 2);
+		if (compareName(getGameid(state->selected_list[mid], gamedata)->name, game->name) <= 0){
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	memmove(&state->selected_list[low + 1], &state->selected_list[low], (state->selected_max - low) * sizeof(unsigned int));
+	state->selected_list[low] = game->gameid;
+	state->selected_max++;
+}
+
+int names_Resolve(state_t *state, gamedata_t *gamedata, int batch){
+	// Load the real names of the next few games still showing their directory name, and
+	// move any which are renamed to their new place in the sorted game list and in the
+	// selection list. The selected game stays selected, wherever it has moved to.
+	// Returns the number of games renamed.
+	
+	// gamedata: Head of the gamedata list; the first game after it may change
+	// batch: Most launch.dat files to read, up to NAMES_BATCH
+	
+	int i;
+	int n;
+	int renamed;
+	int finished;
+	int selected[NAMES_BATCH];
+	unsigned int pos;
+	unsigned int kept;
+	unsigned int page;
+	char new_name[MAX_NAME_SIZE];
+	gamedata_t *games[NAMES_BATCH];
+	gamedata_t *game = NULL;
+	gamedata_t *moved = NULL;
+	gamedata_t *p = NULL;
+	gamedata_t *q = NULL;
+	
+	if (batch > NAMES_BATCH){
+		batch = NAMES_BATCH;
+	}
+	
+	// Pick out the next games still showing their directory name
+	n = 0;
+	finished = 0;
+	while ((n < batch) && (names_done == 0)){
+		game = getGameid(names_next, gamedata->next);
+		if (game == NULL){
+			names_done = 1;
+			finished = 1;
+			if (NAMES_VERBOSE){
+				printf("%s.%d\t All names loaded\n", __FILE__, __LINE__);
+			}
+		} else {
+			names_next++;
+			if (game->has_name == NAMES_PENDING){
+				games[n] = game;
+				n++;
+			}
+		}
+	}
+	
+	// Load their names; only those which actually changed need to move
+	renamed = 0;
+	for(i = 0; i < n; i++){
+		game = games[i];
+		names_loaded++;
+		strcpy(new_name, game->name);
+		getLaunchdataName(game, new_name);
+		if (strcmp(new_name, game->name) != 0){
+			if (NAMES_VERBOSE){
+				printf("%s.%d\t Renamed [%s] to [%s]\n", __FILE__, __LINE__, game->name, new_name);
+			}
+			setGameName(game, new_name);
+			game->has_name = NAMES_LOADING;
+			games[renamed] = game;
+			renamed++;
+		} else {
+			game->has_name = NAMES_RESOLVED;
+		}
+	}
+	
+	// The query and search indexes are in sorted order, but are left alone while names
+	// load; they are freed just the once, when the last name is in, and rebuilt the next
+	// time they are used
+	if (finished && ((names_moved > 0) || (renamed > 0))){
+		query_Free();
+		search_Free();
+	}
+	if (renamed == 0){
+		return 0;
+	}
+	names_moved++;
+	
+	// Unlink the renamed games from the list in one pass, insertion
+	// sorting them into a short list of their own as they are found
+	p = gamedata;
+	while (p->next != NULL){
+		if (p->next->has_name == NAMES_LOADING){
+			game = p->next;
+			p->next = game->next;
+			if ((moved == NULL) || (compareName(game->name, moved->name) < 0)){
+				game->next = moved;
+				moved = game;
+			} else {
+				q = moved;
+				while ((q->next != NULL) && (compareName(q->next->name, game->name) <= 0)){
+					q = q->next;
+				}
+				game->next = q->next;
+				q->next = game;
+			}
+		} else {
+			p = p->next;
+		}
+	}
+	
+	// Merge them back in, in one more pass; both lists are sorted
+	p = gamedata;
+	while (moved != NULL){
+		game = moved;
+		moved = moved->next;
+		while ((p->next != NULL) && (compareName(p->next->name, game->name) <= 0)){
+			p = p->next;
+		}
+		game->next = p->next;
+		p->next = game;
+		p = game;
+	}
+	
+	// Take the renamed games out of the selection list...
+	for(i = 0; i < renamed; i++){
+		selected[i] = 0;
+	}
+	kept = 0;
+	for(pos = 0; pos < state->selected_max; pos++){
+		for(i = 0; i < renamed; i++){
+			if (state->selected_list[pos] == (unsigned int) games[i]->gameid){
+				selected[i] = 1;
+				break;
+			}
+		}
+		if (i == renamed){
+			state->selected_list[kept] = state->selected_list[pos];
+			kept++;
+		}
+	}
+	state->selected_max = kept;
+	
+	// ... and put them back where they now sort
+	for(i = 0; i < renamed; i++){
+		if (selected[i]){
+			names_Select(state, gamedata->next, games[i]);
+		}
+		games[i]->has_name = NAMES_RESOLVED;
+	}
+	
+	// Follow the selected game to wherever it is now
+	for(pos = 0; pos < state->selected_max; pos++){
+		if (state->selected_list[pos] == (unsigned int) state->selected_gameid){
+			page = (pos / ui_browser_max_lines) + 1;
+			if (page != state->selected_page){
+				state->page_changed = 1;
+			}
+			state->selected_page = page;
+			state->selected_line = pos % ui_browser_max_lines;
+			break;
+		}
+	}
+	
+	// Type-ahead follows the new order, and keeps what has been typed so far
+	search_IndexPrefix(state, gamedata->next);
+	
+	return renamed;
+}
@@ -0,0 +1,42 @@
+/* names.h, Background loading of real game names for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#ifndef __HAS_MAIN
+#include "main.h"
+#define __HAS_MAIN
+#endif
+
+// Defaults
+#define NAMES_VERBOSE		0			// Enable/disable logging for these functions
+#define NAMES_OK				0			// Success returncode
+#define NAMES_ERR			-1			// Failure returncode
+#define NAMES_BATCH			4			// Number of launch.dat files read each time the main loop is idle
+
+// Values of gamedata_t.has_name
+#define NAMES_PENDING		0			// Still showing the directory name, real name not loaded yet
+#define NAMES_RESOLVED		1			// Real name loaded, or there is none to load
+#define NAMES_LOADING		2			// In the batch currently being loaded
+
+// Function prototypes
+int		names_Pending();
+int		names_Loaded();
+unsigned int	names_Moved();
+int		names_Resolve(state_t *state, gamedata_t *gamedata, int batch);
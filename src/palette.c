@@ -17,7 +17,6 @@
 */
 
 #include <stdio.h>
-#include <conio.h>
 
 #ifndef __HAS_BMP
 #include "bmp.h"
@@ -28,6 +27,7 @@
 #include "palette.h"
 #define __HAS_PAL
 #endif
+#include "platform.h"
 
 unsigned int free_palettes_used;			// Current number of palette entries used
 unsigned int reserved_palettes_used;		// Current number of palette entries used
@@ -205,11 +205,7 @@ void pal_ResetAll(){
 	}
 	
 	for (i = 0; i < 256; i++){
-		outp(VGA_PALETTE_MASK_ADDR, 0xFF);
-		outp(VGA_PALETTE_SEL_ADDR, i);
-		outp(VGA_PALETTE_SET_ADDR, 0x0);
-		outp(VGA_PALETTE_SET_ADDR, 0x0);
-		outp(VGA_PALETTE_SET_ADDR, 0x0);	
+		platform_PaletteSet(i, 0x0, 0x0, 0x0);
 	}
 	
 	reserved_palettes_used = 0;
@@ -228,11 +224,7 @@ void pal_ResetFree(){
 	}
 	
 	for (i = 0; i < PALETTES_FREE; i++){
-		outp(VGA_PALETTE_MASK_ADDR, 0xFF);
-		outp(VGA_PALETTE_SEL_ADDR, i);
-		outp(VGA_PALETTE_SET_ADDR, 0x0);
-		outp(VGA_PALETTE_SET_ADDR, 0x0);
-		outp(VGA_PALETTE_SET_ADDR, 0x0);	
+		platform_PaletteSet(i, 0x0, 0x0, 0x0);
 	}
 	
 	free_palettes_used = 0;
@@ -246,16 +238,10 @@ void pal_Set(unsigned char idx, unsigned char r, unsigned char g, unsigned char
 		printf("%s.%d\t pal_Set() Set palette #%3d r:%3d g:%3d b:%3d (DAC mode %dbpp)\n", __FILE__, __LINE__, idx, r, g, b, vga_dac_type);
 	}
 	
-	outp(VGA_PALETTE_MASK_ADDR, 0xFF);
-	outp(VGA_PALETTE_SEL_ADDR, idx);
 	if (vga_dac_type == VGA_PALETTE_8BPP){
-		outp(VGA_PALETTE_SET_ADDR, r);
-		outp(VGA_PALETTE_SET_ADDR, g);
-		outp(VGA_PALETTE_SET_ADDR, b);
+		platform_PaletteSet(idx, r, g, b);
 	} else {
-		outp(VGA_PALETTE_SET_ADDR, r >> 2);
-		outp(VGA_PALETTE_SET_ADDR, g >> 2);
-		outp(VGA_PALETTE_SET_ADDR, b >> 2);
+		platform_PaletteSet(idx, r >> 2, g >> 2, b >> 2);
 	}
 	return;
 }
@@ -285,11 +271,7 @@ void pal_Get(){
 	unsigned char r, g, b;
 	
 	for (idx = 0; idx < 256; idx++){
-		outp(VGA_PALETTE_MASK_ADDR, 0xFF);
-		outp(VGA_PALETTE_SEL_ADDR, idx);
-		r = inp(VGA_PALETTE_SET_ADDR);
-		g = inp(VGA_PALETTE_SET_ADDR);
-		b = inp(VGA_PALETTE_SET_ADDR);
+		platform_PaletteGet((unsigned char) idx, &r, &g, &b);
 		printf("%s.%d\t pal_Get() Get palette #%3d : r:%3d g:%3d b:%3d\n", __FILE__, __LINE__, idx, r, g, b);
 	}
 }
@@ -0,0 +1,69 @@
+/* platform.h, Hardware and operating system calls for the x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Everything that touches the video BIOS, the VGA DAC, the keyboard or
+// DOS drive and directory calls goes through these functions. platform_dos.c
+// implements them for the real thing, platform_host.c has headless stand-ins
+// so that the rest of the code can be built and profiled on a build host.
+
+#include <stdio.h>
+
+// Defaults
+#define PLATFORM_VERBOSE		0			// Enable/disable logging for these functions
+#define PLATFORM_OK			0			// Success returncode
+#define PLATFORM_ERR			-1			// Failure returncode
+#define PLATFORM_NAME_SIZE	13			// An 8.3 filename and terminator
+
+// A single entry read from a directory
+typedef struct platform_dirent {
+	char name[PLATFORM_NAME_SIZE];		// File or directory name, without any path
+	unsigned char is_dir;				// Set if the entry is a sub-directory
+	unsigned short date;					// DOS date stamp of the entry
+	unsigned short time;					// DOS time stamp of the entry
+} platform_dirent_t;
+
+// An open directory, only used through the functions below
+typedef struct platform_dir platform_dir_t;
+
+// Video mode, memory windows and palette DAC
+int		platform_VideoOpen(unsigned short mode, long int *window_bytes, unsigned char *dac_type);
+void	platform_VideoClose(unsigned short mode);
+void	platform_VideoWrite(unsigned short window, unsigned int offset, unsigned char __huge *src, long int bytes);
+void	platform_PaletteSet(unsigned char idx, unsigned char r, unsigned char g, unsigned char b);
+void	platform_PaletteGet(unsigned char idx, unsigned char *r, unsigned char *g, unsigned char *b);
+
+// Keyboard and timing
+int		platform_KeyHit();
+int		platform_KeyGet();
+void	platform_Delay(unsigned int ms);
+
+// Memory
+int		platform_HeapInfo(unsigned long *near_free, unsigned long *far_free, unsigned long *largest);
+
+// Drives, directories and files
+unsigned	platform_GetDrive();
+void	platform_SetDrive(unsigned drive);
+char *	platform_GetDir(char *buffer, int size);
+int		platform_ChangeDir(char *path);
+int		platform_MakeDir(char *path);
+platform_dir_t *		platform_OpenDir(char *path);
+platform_dirent_t *	platform_ReadDir(platform_dir_t *dir);
+void	platform_CloseDir(platform_dir_t *dir);
+int		platform_DirStamp(char *path, unsigned short *date, unsigned short *time);
+int		platform_FileStamp(char *path, unsigned long *size, unsigned short *date, unsigned short *time);
+int		platform_FileExists(char *path);
+FILE *	platform_Open(char *path, char *mode);
@@ -0,0 +1,395 @@
+/* platform_dos.c, Hardware and operating system calls for the x86Launcher under DOS.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <conio.h>
+#include <dos.h>
+#include <direct.h>
+#include <i86.h>
+#include <malloc.h>
+
+#include "platform.h"
+#include "vesa.h"
+
+#ifndef __HAS_PAL
+#include "palette.h"
+#define __HAS_PAL
+#endif
+
+struct platform_dir {
+	DIR *dir;							// Open directory from opendir()
+	platform_dirent_t entry;				// The last entry read
+};
+
+static unsigned char *VGA = (unsigned char *) 0xA0000000L;	// Position of the VGA memory region
+static int platform_window = -1;								// Video memory window mapped in, or -1 if not known
+
+int platform_VideoOpen(unsigned short mode, long int *window_bytes, unsigned char *dac_type){
+	// Find and set a VESA mode, switching the DAC to 8bpp if we can.
+	// Returns the size of a video memory window and the DAC width.
+	
+	int status;
+	vbeinfo_t *vbeinfo = NULL;
+	vesamodeinfo_t *vesamodeinfo = NULL;
+	
+	vbeinfo = (vbeinfo_t *) malloc(sizeof(vbeinfo_t));
+	vesamodeinfo = (vesamodeinfo_t *) malloc(sizeof(vesamodeinfo_t));
+	
+	// Look for a VESA BIOS structure
+	status = vesa_GetVBEInfo(vbeinfo);
+	if (status < 0){
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_VideoOpen() Error, Unable to complete gfx initialisation [VBE BIOS missing]\n", __FILE__, __LINE__);
+		}
+		free(vbeinfo);
+		free(vesamodeinfo);
+		return PLATFORM_ERR;
+	} else {
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_VideoOpen() Found a VESA BIOS\n", __FILE__, __LINE__);
+		}
+	}
+	
+	// Find the mode
+	status = vesa_HasMode(mode, vbeinfo);
+	if (status < 0){
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_VideoOpen() Error, Unable to complete gfx initialisation [VESA mode missing]\n", __FILE__, __LINE__);
+		}
+		free(vbeinfo);
+		free(vesamodeinfo);
+		return PLATFORM_ERR;
+	} else {
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_VideoOpen() Found VESA mode %xh\n", __FILE__, __LINE__, mode);
+		}
+	}
+	
+	// Load the mode information
+	status = vesa_GetModeInfo(mode, vesamodeinfo);
+	if (status < 0){
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_VideoOpen() Error, Unable to complete gfx initialisation [VESA mode lookup]\n", __FILE__, __LINE__);
+		}
+		free(vbeinfo);
+		free(vesamodeinfo);
+		return PLATFORM_ERR;
+	} else {
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_VideoOpen() Retrieved VESA mode details %xh\n", __FILE__, __LINE__, mode);
+		}
+	}
+	
+	// Set the mode
+	status = vesa_SetMode(mode);
+	if (status < 0){
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_VideoOpen() Error, Unable to complete gfx initialisation [VESA set mode failed]\n", __FILE__, __LINE__);
+		}
+		free(vbeinfo);
+		free(vesamodeinfo);
+		return PLATFORM_ERR;
+	} else {
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_VideoOpen() Set VESA mode %xh\n", __FILE__, __LINE__, mode);
+		}
+	}
+	
+	// Set VGA DAC type
+	*dac_type = VGA_PALETTE_6BPP;
+	if (vbeinfo->capabilities & 0x01){
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_VideoOpen() Trying to switch VGA DAC to %dbpp\n", __FILE__, __LINE__, VGA_PALETTE_8BPP);
+		}
+	
+		// DAC is programmable - we need to try to switch it to 8bit mode
+		status = vesa_SetDAC(VGA_PALETTE_8BPP);
+		if (status < 0){
+			if (PLATFORM_VERBOSE){
+				printf("%s.%d\t platform_VideoOpen() Unable to switch VGA DAC, defaulting to %dbpp\n", __FILE__, __LINE__, VGA_PALETTE_DEFAULT);
+			}
+			*dac_type = VGA_PALETTE_6BPP;
+		} else {
+			status = vesa_GetDAC(VGA_PALETTE_8BPP);
+			if (status < 0){
+				// Yes, switched to 8bit mode
+				if (PLATFORM_VERBOSE){
+					printf("%s.%d\t platform_VideoOpen() VGA DAC now in %dbpp\n", __FILE__, __LINE__, VGA_PALETTE_8BPP);
+				}
+				*dac_type = VGA_PALETTE_8BPP;
+			} else {
+				// Switching failed, assume 6bpp
+				if (PLATFORM_VERBOSE){
+					printf("%s.%d\t platform_VideoOpen() Warning, VGA DAC not in desired mode, defaulting to %dbpp\n", __FILE__, __LINE__, VGA_PALETTE_6BPP);
+				}
+				*dac_type = VGA_PALETTE_6BPP;
+			}
+		}
+	} else {
+		// DAC is NON-programmable. Palette entries need to be truncated to 6bpp.
+		status = vesa_SetDAC(VGA_PALETTE_8BPP);
+	}
+	
+	*window_bytes = (long int) vesamodeinfo->WinSize * 1024;
+	platform_window = -1;
+	if (PLATFORM_VERBOSE){
+		printf("%s.%d\t platform_VideoOpen() VESA memory window segment address: %xh\n", __FILE__, __LINE__, vesamodeinfo->WinASegment);
+	}
+	
+	free(vbeinfo);
+	free(vesamodeinfo);
+	return PLATFORM_OK;
+}
+
+void platform_VideoClose(unsigned short mode){
+	// Return to a previous video mode, normally text mode
+	
+	vesa_SetMode(mode);
+	platform_window = -1;
+}
+
+void platform_VideoWrite(unsigned short window, unsigned int offset, unsigned char __huge *src, long int bytes){
+	// Copy a block of pixels to an offset in a video memory window. The window is only
+	// switched if it isn't the one already mapped in, as that is a slow BIOS call. A
+	// whole 64KB window is more than a single _fmemcpy() can copy, so it is done in parts.
+	
+	unsigned int part;
+	
+	if (platform_window != (int) window){
+		vesa_SetWindow(window);
+		platform_window = window;
+	}
+	while (bytes > 0){
+		if (bytes > 0x8000L){
+			part = 0x8000;
+		} else {
+			part = (unsigned int) bytes;
+		}
+		_fmemcpy(VGA + offset, src, part);
+		offset += part;
+		src += part;
+		bytes -= part;
+	}
+}
+
+void platform_PaletteSet(unsigned char idx, unsigned char r, unsigned char g, unsigned char b){
+	// Write a palette entry to the VGA DAC, values already scaled to the DAC width
+	
+	outp(VGA_PALETTE_MASK_ADDR, 0xFF);
+	outp(VGA_PALETTE_SEL_ADDR, idx);
+	outp(VGA_PALETTE_SET_ADDR, r);
+	outp(VGA_PALETTE_SET_ADDR, g);
+	outp(VGA_PALETTE_SET_ADDR, b);
+}
+
+void platform_PaletteGet(unsigned char idx, unsigned char *r, unsigned char *g, unsigned char *b){
+	// Read a palette entry back from the VGA DAC
+	
+	outp(VGA_PALETTE_MASK_ADDR, 0xFF);
+	outp(VGA_PALETTE_SEL_ADDR, idx);
+	*r = inp(VGA_PALETTE_SET_ADDR);
+	*g = inp(VGA_PALETTE_SET_ADDR);
+	*b = inp(VGA_PALETTE_SET_ADDR);
+}
+
+int platform_KeyHit(){
+	// Returns true if a key is waiting
+	
+	return kbhit();
+}
+
+int platform_KeyGet(){
+	// Wait for and return the next key; extended keys come back as 0 followed by their code
+	
+	return getch();
+}
+
+void platform_Delay(unsigned int ms){
+	// Wait for a number of milliseconds
+	
+	delay(ms);
+}
+
+int platform_HeapInfo(unsigned long *near_free, unsigned long *far_free, unsigned long *largest){
+	// Return the free space in the near heap, the free space in the far heap plus the
+	// DOS memory it can still grow into, and the largest block that could be allocated
+	
+	struct _heapinfo entry;
+	unsigned segment;
+	unsigned long dos_free;
+	
+	*near_free = _memavl();
+	*largest = _memmax();
+	
+	// Free entries already in the far heap
+	*far_free = 0;
+	entry._pentry = NULL;
+	while (_fheapwalk(&entry) == _HEAPOK){
+		if (entry._useflag == _FREEENTRY){
+			*far_free += entry._size;
+			if (entry._size > *largest){
+				*largest = entry._size;
+			}
+		}
+	}
+	
+	// Asking DOS for more than it can have fails, and returns the largest block it does have
+	segment = 0;
+	if (_dos_allocmem(0xFFFF, &segment) == 0){
+		_dos_freemem(segment);
+		segment = 0xFFFF;
+	}
+	dos_free = (unsigned long) segment * 16;
+	*far_free += dos_free;
+	if (dos_free > *largest){
+		*largest = dos_free;
+	}
+	return PLATFORM_OK;
+}
+
+unsigned platform_GetDrive(){
+	// Returns the current drive number, 1 == A:, or 0 if it can't be read
+	
+	unsigned drive;
+	
+	drive = 0;
+	_dos_getdrive(&drive);
+	return drive;
+}
+
+void platform_SetDrive(unsigned drive){
+	// Change the current drive, 1 == A:
+	
+	unsigned drives;
+	
+	_dos_setdrive(drive, &drives);
+}
+
+char * platform_GetDir(char *buffer, int size){
+	// Return the current drive and directory
+	
+	return getcwd(buffer, size);
+}
+
+int platform_ChangeDir(char *path){
+	// Change the current directory, returns 0 on success
+	
+	return chdir(path);
+}
+
+int platform_MakeDir(char *path){
+	// Create a directory, returns 0 on success
+	
+	return mkdir(path);
+}
+
+platform_dir_t * platform_OpenDir(char *path){
+	// Open a directory to read its entries, or return NULL if it isn't one
+	
+	platform_dir_t *dir = NULL;
+	
+	dir = (platform_dir_t *) malloc(sizeof(platform_dir_t));
+	if (dir == NULL){
+		return NULL;
+	}
+	dir->dir = opendir(path);
+	if (dir->dir == NULL){
+		free(dir);
+		return NULL;
+	}
+	return dir;
+}
+
+platform_dirent_t * platform_ReadDir(platform_dir_t *dir){
+	// Return the next entry of an open directory, or NULL at the end
+	
+	struct dirent *de;
+	
+	de = readdir(dir->dir);
+	if (de == NULL){
+		return NULL;
+	}
+	strncpy(dir->entry.name, de->d_name, PLATFORM_NAME_SIZE - 1);
+	dir->entry.name[PLATFORM_NAME_SIZE - 1] = '\0';
+	dir->entry.is_dir = ((de->d_attr & _A_SUBDIR) != 0);
+	dir->entry.date = de->d_date;
+	dir->entry.time = de->d_time;
+	return &dir->entry;
+}
+
+void platform_CloseDir(platform_dir_t *dir){
+	// Close a directory opened with platform_OpenDir()
+	
+	if (dir != NULL){
+		closedir(dir->dir);
+		free(dir);
+	}
+}
+
+int platform_DirStamp(char *path, unsigned short *date, unsigned short *time){
+	// Return the DOS date and time stamp of the directory entry for a path
+	
+	struct find_t ffblk;
+	unsigned status;
+	
+	status = _dos_findfirst(path, _A_SUBDIR, &ffblk);
+	if (status != 0){
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_DirStamp() Unable to read directory stamp [status:%d][path:%s]\n", __FILE__, __LINE__, status, path);
+		}
+		return PLATFORM_ERR;
+	}
+	*date = ffblk.wr_date;
+	*time = ffblk.wr_time;
+	_dos_findclose(&ffblk);
+	return PLATFORM_OK;
+}
+
+int platform_FileStamp(char *path, unsigned long *size, unsigned short *date, unsigned short *time){
+	// Return the size and DOS date and time stamp of a file; a single find-first call, as for platform_FileExists()
+	
+	struct find_t ffblk;
+	
+	if (_dos_findfirst(path, _A_NORMAL | _A_RDONLY | _A_HIDDEN | _A_ARCH, &ffblk) != 0){
+		return PLATFORM_ERR;
+	}
+	*size = ffblk.size;
+	*date = ffblk.wr_date;
+	*time = ffblk.wr_time;
+	_dos_findclose(&ffblk);
+	return PLATFORM_OK;
+}
+
+int platform_FileExists(char *path){
+	// Returns true if a file exists; a single find-first call, rather than opening and closing the file
+	
+	struct find_t ffblk;
+	
+	if (_dos_findfirst(path, _A_NORMAL | _A_RDONLY | _A_HIDDEN | _A_ARCH, &ffblk) == 0){
+		_dos_findclose(&ffblk);
+		return 1;
+	}
+	return 0;
+}
+
+FILE * platform_Open(char *path, char *mode){
+	// Open a file
+	
+	return fopen(path, mode);
+}
@@ -0,0 +1,330 @@
+/* platform_host.c, Headless stand-ins for the hardware and operating system calls
+ of the x86Launcher, so that it can be built and profiled on a Linux build host.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/select.h>
+
+#include "platform.h"
+
+#ifndef __HAS_PAL
+#include "palette.h"
+#define __HAS_PAL
+#endif
+
+// Every drive letter is the root of the host filesystem, so C:\Games\Doom is /Games/Doom
+#define PLATFORM_HOST_DRIVE		3			// Drive number reported as current, C:
+#define PLATFORM_HOST_PATH		1024		// Size of a host path buffer
+#define PLATFORM_HOST_WINDOW		65536		// Size of a video memory window
+#define PLATFORM_HOST_WINDOWS	16			// Number of video memory windows in the framebuffer
+
+struct platform_dir {
+	DIR *dir;							// Open directory from opendir()
+	char path[PLATFORM_HOST_PATH];		// Host path of the directory, to stat each entry
+	platform_dirent_t entry;				// The last entry read
+};
+
+static unsigned char *platform_framebuffer = NULL;		// Stands in for video memory
+static unsigned char platform_dac[256][3];				// Stands in for the VGA DAC
+
+static void platform_Path(char *path, char *buffer){
+	// Turn a DOS path into a host path; drop any drive letter and turn backslashes around
+	
+	char *p;
+	
+	if ((path[0] != '\0') && (path[1] == ':')){
+		path += 2;
+	}
+	strncpy(buffer, path, PLATFORM_HOST_PATH - 1);
+	buffer[PLATFORM_HOST_PATH - 1] = '\0';
+	for(p = buffer; *p != '\0'; p++){
+		if (*p == '\\'){
+			*p = '/';
+		}
+	}
+	if (buffer[0] == '\0'){
+		strcpy(buffer, "/");
+	}
+}
+
+static void platform_Stamp(time_t t, unsigned short *date, unsigned short *time){
+	// Turn a host timestamp into DOS date and time stamps
+	
+	struct tm *tm;
+	
+	tm = localtime(&t);
+	*date = (unsigned short) (((tm->tm_year - 80) << 9) | ((tm->tm_mon + 1) << 5) | tm->tm_mday);
+	*time = (unsigned short) ((tm->tm_hour << 11) | (tm->tm_min << 5) | (tm->tm_sec / 2));
+}
+
+int platform_VideoOpen(unsigned short mode, long int *window_bytes, unsigned char *dac_type){
+	// There is no display; pixels are flipped to a framebuffer in memory instead
+	
+	if (platform_framebuffer == NULL){
+		platform_framebuffer = (unsigned char *) calloc(PLATFORM_HOST_WINDOWS, PLATFORM_HOST_WINDOW);
+		if (platform_framebuffer == NULL){
+			return PLATFORM_ERR;
+		}
+	}
+	*window_bytes = PLATFORM_HOST_WINDOW;
+	*dac_type = VGA_PALETTE_8BPP;
+	if (PLATFORM_VERBOSE){
+		printf("%s.%d\t platform_VideoOpen() Headless video mode %xh\n", __FILE__, __LINE__, mode);
+	}
+	return PLATFORM_OK;
+}
+
+void platform_VideoClose(unsigned short mode){
+	// Release the framebuffer
+	
+	if (platform_framebuffer != NULL){
+		free(platform_framebuffer);
+		platform_framebuffer = NULL;
+	}
+}
+
+void platform_VideoWrite(unsigned short window, unsigned int offset, unsigned char __huge *src, long int bytes){
+	// Copy a block of pixels to an offset in a window of the framebuffer
+	
+	if ((platform_framebuffer == NULL) || (window >= PLATFORM_HOST_WINDOWS) || ((offset + bytes) > PLATFORM_HOST_WINDOW)){
+		return;
+	}
+	memcpy(platform_framebuffer + ((long int) window * PLATFORM_HOST_WINDOW) + offset, src, bytes);
+}
+
+void platform_PaletteSet(unsigned char idx, unsigned char r, unsigned char g, unsigned char b){
+	// Keep a palette entry
+	
+	platform_dac[idx][0] = r;
+	platform_dac[idx][1] = g;
+	platform_dac[idx][2] = b;
+}
+
+void platform_PaletteGet(unsigned char idx, unsigned char *r, unsigned char *g, unsigned char *b){
+	// Return a palette entry
+	
+	*r = platform_dac[idx][0];
+	*g = platform_dac[idx][1];
+	*b = platform_dac[idx][2];
+}
+
+int platform_KeyHit(){
+	// Keys are read from stdin, so they can be piped in
+	
+	fd_set fds;
+	struct timeval tv;
+	
+	FD_ZERO(&fds);
+	FD_SET(0, &fds);
+	tv.tv_sec = 0;
+	tv.tv_usec = 0;
+	return (select(1, &fds, NULL, NULL, &tv) > 0);
+}
+
+int platform_KeyGet(){
+	// Return the next key from stdin; running out of input is the same as pressing escape
+	
+	int k;
+	
+	k = getchar();
+	if (k == EOF){
+		return 0x1B;
+	}
+	if (k == '\n'){
+		return 0x0D;
+	}
+	return k;
+}
+
+void platform_Delay(unsigned int ms){
+	// Wait for a number of milliseconds
+	
+	usleep(ms * 1000);
+}
+
+int platform_HeapInfo(unsigned long *near_free, unsigned long *far_free, unsigned long *largest){
+	// A host has no DOS heaps to look at
+	
+	*near_free = 0;
+	*far_free = 0;
+	*largest = 0;
+	return PLATFORM_ERR;
+}
+
+unsigned platform_GetDrive(){
+	// There is only the one drive
+	
+	return PLATFORM_HOST_DRIVE;
+}
+
+void platform_SetDrive(unsigned drive){
+	// There is only the one drive
+	
+	return;
+}
+
+char * platform_GetDir(char *buffer, int size){
+	// Return the current directory as a DOS path, e.g. /home/me becomes C:\home\me
+	
+	char cwd[PLATFORM_HOST_PATH];
+	char *p;
+	
+	if (getcwd(cwd, sizeof(cwd)) == NULL){
+		return NULL;
+	}
+	if ((int) strlen(cwd) + 3 > size){
+		return NULL;
+	}
+	buffer[0] = 'A' + PLATFORM_HOST_DRIVE - 1;
+	buffer[1] = ':';
+	strcpy(buffer + 2, cwd);
+	for(p = buffer; *p != '\0'; p++){
+		if (*p == '/'){
+			*p = '\\';
+		}
+	}
+	return buffer;
+}
+
+int platform_ChangeDir(char *path){
+	// Change the current directory, returns 0 on success
+	
+	char host_path[PLATFORM_HOST_PATH];
+	
+	platform_Path(path, host_path);
+	return chdir(host_path);
+}
+
+int platform_MakeDir(char *path){
+	// Create a directory, returns 0 on success
+	
+	char host_path[PLATFORM_HOST_PATH];
+	
+	platform_Path(path, host_path);
+	return mkdir(host_path, 0777);
+}
+
+platform_dir_t * platform_OpenDir(char *path){
+	// Open a directory to read its entries, or return NULL if it isn't one
+	
+	platform_dir_t *dir = NULL;
+	
+	dir = (platform_dir_t *) malloc(sizeof(platform_dir_t));
+	if (dir == NULL){
+		return NULL;
+	}
+	platform_Path(path, dir->path);
+	dir->dir = opendir(dir->path);
+	if (dir->dir == NULL){
+		free(dir);
+		return NULL;
+	}
+	return dir;
+}
+
+platform_dirent_t * platform_ReadDir(platform_dir_t *dir){
+	// Return the next entry of an open directory, or NULL at the end
+	
+	struct dirent *de;
+	struct stat st;
+	char host_path[PLATFORM_HOST_PATH];
+	
+	// Names too long for DOS are skipped, as they could never be there
+	do {
+		de = readdir(dir->dir);
+		if (de == NULL){
+			return NULL;
+		}
+	} while (strlen(de->d_name) >= PLATFORM_NAME_SIZE);
+	strcpy(dir->entry.name, de->d_name);
+	dir->entry.is_dir = 0;
+	dir->entry.date = 0;
+	dir->entry.time = 0;
+	sprintf(host_path, "%.*s/%s", PLATFORM_HOST_PATH - PLATFORM_NAME_SIZE - 1, dir->path, de->d_name);
+	if (stat(host_path, &st) == 0){
+		dir->entry.is_dir = S_ISDIR(st.st_mode) ? 1 : 0;
+		platform_Stamp(st.st_mtime, &dir->entry.date, &dir->entry.time);
+	}
+	return &dir->entry;
+}
+
+void platform_CloseDir(platform_dir_t *dir){
+	// Close a directory opened with platform_OpenDir()
+	
+	if (dir != NULL){
+		closedir(dir->dir);
+		free(dir);
+	}
+}
+
+int platform_DirStamp(char *path, unsigned short *date, unsigned short *time){
+	// Return the DOS date and time stamp of a directory
+	
+	struct stat st;
+	char host_path[PLATFORM_HOST_PATH];
+	
+	platform_Path(path, host_path);
+	if ((stat(host_path, &st) != 0) || (!S_ISDIR(st.st_mode))){
+		if (PLATFORM_VERBOSE){
+			printf("%s.%d\t platform_DirStamp() Unable to read directory stamp [path:%s]\n", __FILE__, __LINE__, host_path);
+		}
+		return PLATFORM_ERR;
+	}
+	platform_Stamp(st.st_mtime, date, time);
+	return PLATFORM_OK;
+}
+
+int platform_FileStamp(char *path, unsigned long *size, unsigned short *date, unsigned short *time){
+	// Return the size and DOS date and time stamp of a file
+	
+	struct stat st;
+	char host_path[PLATFORM_HOST_PATH];
+	
+	platform_Path(path, host_path);
+	if ((stat(host_path, &st) != 0) || (!S_ISREG(st.st_mode))){
+		return PLATFORM_ERR;
+	}
+	*size = (unsigned long) st.st_size;
+	platform_Stamp(st.st_mtime, date, time);
+	return PLATFORM_OK;
+}
+
+int platform_FileExists(char *path){
+	// Returns true if a file exists
+	
+	struct stat st;
+	char host_path[PLATFORM_HOST_PATH];
+	
+	platform_Path(path, host_path);
+	return ((stat(host_path, &st) == 0) && (S_ISREG(st.st_mode)));
+}
+
+FILE * platform_Open(char *path, char *mode){
+	// Open a file
+	
+	char host_path[PLATFORM_HOST_PATH];
+	
+	platform_Path(path, host_path);
+	return fopen(host_path, mode);
+}
@@ -0,0 +1,676 @@
+/* query.c, Combined genre, series, company and tech spec filtering for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#ifndef __HAS_MAIN
+#include "main.h"
+#define __HAS_MAIN
+#endif
+#include "names.h"
+#include "query.h"
+#include "search.h"
+#include "ui.h"
+
+// Games are numbered by their position in the sorted game list, and a query result is a
+// bitset with one bit per position, so the bits of a result come out already in browser order.
+//
+// Every facet value has a posting of the games that have it. The first word of a posting is
+// the number of games. Most values (a series, a company) belong to only a handful of games, so
+// when that number is less than the words in a bitset the games follow as a sorted list of
+// positions, which is smaller; only the common values (genres, tech specs) follow as a bitset.
+static int query_games = 0;									// Number of games in the bitsets
+static int query_words = 0;									// Number of qword_t in each bitset
+static unsigned int *query_order = NULL;						// Gameid of the game at each bit position
+static qword_t *query_all = NULL;								// Every game
+static unsigned int query_moved = 0;							// names_Moved() when the postings were built
+static qword_t *query_result = NULL;							// Result of the last query, or of the last query_Count*() call
+static qword_t *query_scratch = NULL;							// OR of the terms within one facet
+static qword_t **query_keywords[QUERY_FACETS];				// Keyword facet postings, indexed by keyword id
+static unsigned int query_keywords_size = 0;					// Number of keyword ids in each of the above
+static qword_t *query_hardware_bits[QUERY_HW_BITS];			// Tech spec postings, indexed by hardware bit number
+
+// The query itself
+static unsigned short query_terms[QUERY_FACETS][QUERY_TERMS];	// Keyword ids OR'ed together within each facet
+static int query_nterms[QUERY_FACETS];						// Number of keyword ids set for each facet
+static hwdata_t query_hardware = 0;							// Tech specs which must all be present
+
+// The query as it was the last time it filled the selection list, to go back to if a new one fails
+static unsigned short query_last_terms[QUERY_FACETS][QUERY_TERMS];
+static int query_last_nterms[QUERY_FACETS];
+static hwdata_t query_last_hardware = 0;
+
+static qword_t * query_NewBitset(){
+	// Allocate an empty bitset large enough for every game
+	
+	return (qword_t *) calloc(query_words, sizeof(qword_t));
+}
+
+static int query_IsList(unsigned int count){
+	// Whether the posting of a value with this many games is a list of positions, rather than a bitset
+	
+	return (count < (unsigned int) query_words);
+}
+
+static qword_t * query_NewPosting(unsigned int count){
+	// Allocate an empty posting for a value with a number of games
+	
+	qword_t *posting = NULL;
+	
+	if (query_IsList(count)){
+		// The count goes up as positions are added, and ends up at the same number
+		posting = (qword_t *) malloc((count + 1) * sizeof(qword_t));
+		if (posting != NULL){
+			posting[0] = 0;
+		}
+	} else {
+		posting = (qword_t *) calloc(query_words + 1, sizeof(qword_t));
+		if (posting != NULL){
+			posting[0] = count;
+		}
+	}
+	return posting;
+}
+
+static void query_AddPosition(qword_t *posting, unsigned int count, int pos){
+	// Add a game to the posting of a value with count games. Positions are added in
+	// ascending order, so a game listed twice (same developer and publisher) is the last one.
+	
+	if (query_IsList(count)){
+		if ((posting[0] == 0) || (posting[posting[0]] != (qword_t) pos)){
+			posting[0]++;
+			posting[posting[0]] = pos;
+		}
+	} else {
+		posting[1 + (pos / QUERY_WORD_BITS)] |= ((qword_t) 1 << (pos % QUERY_WORD_BITS));
+	}
+}
+
+static void query_Or(qword_t *bitset, qword_t *posting){
+	// Add the games of a posting to a bitset
+	
+	int w;
+	unsigned int i;
+	qword_t pos;
+	
+	if (query_IsList(posting[0])){
+		for(i = 1; i <= posting[0]; i++){
+			pos = posting[i];
+			bitset[pos / QUERY_WORD_BITS] |= ((qword_t) 1 << (pos % QUERY_WORD_BITS));
+		}
+	} else {
+		for(w = 0; w < query_words; w++){
+			bitset[w] |= posting[w + 1];
+		}
+	}
+}
+
+static unsigned long query_PostingBytes(qword_t *posting){
+	// Returns the bytes allocated for a posting
+	
+	if (query_IsList(posting[0])){
+		return (unsigned long) (posting[0] + 1) * sizeof(qword_t);
+	}
+	return (unsigned long) (query_words + 1) * sizeof(qword_t);
+}
+
+static void query_Count(unsigned int *counts, unsigned short id, unsigned short skip){
+	// Count a game against a keyword id, unless it is the same as skip
+	
+	if ((id != skip) && (id < query_keywords_size)){
+		counts[id]++;
+	}
+}
+
+static void query_Add(qword_t **postings, unsigned int *counts, unsigned short id, unsigned short skip, int pos){
+	// Add a game to the posting of a keyword id, unless it is the same as skip
+	
+	if ((id != skip) && (id < query_keywords_size)){
+		query_AddPosition(postings[id], counts[id], pos);
+	}
+}
+
+static int query_NewPostings(qword_t **postings, unsigned int *counts, unsigned int size){
+	// Allocate a posting for every value with at least one game
+	
+	unsigned int id;
+	
+	for(id = 0; id < size; id++){
+		if (counts[id] > 0){
+			postings[id] = query_NewPosting(counts[id]);
+			if (postings[id] == NULL){
+				return QUERY_ERR;
+			}
+		}
+	}
+	return QUERY_OK;
+}
+
+int query_Build(gamedata_t *gamedata, launchdat_t *filterdat){
+	// Build the postings for every facet value from the sorted list of games. Metadata
+	// is loaded for any game that has not been seen yet; after that no query needs
+	// to look at the game list or metadata again.
+	
+	int i;
+	int pos;
+	int status;
+	unsigned long bit;
+	unsigned int *counts[QUERY_FACETS];
+	unsigned int hw_counts[QUERY_HW_BITS];
+	gamedata_t *gamedata_head;
+	metadata_t *meta = NULL;
+	
+	if (query_all != NULL){
+		if (query_moved == names_Moved()){
+			// Already built
+			return QUERY_OK;
+		}
+		// Built while names were still loading, and games have moved since
+		query_Free();
+	}
+	query_moved = names_Moved();
+	
+	gamedata_head = gamedata;
+	
+	// Load all metadata first, so that the keyword dictionary is complete
+	query_games = 0;
+	while(gamedata != NULL){
+		if (gamedata->has_dat){
+			getMetadata(gamedata, filterdat);
+		}
+		query_games++;
+		gamedata = gamedata->next;
+	}
+	if (query_games > QUERY_MAX_GAMES){
+		if (QUERY_VERBOSE){
+			printf("%s.%d\t Warning - Only the first %d of %d games can be filtered\n", __FILE__, __LINE__, QUERY_MAX_GAMES, query_games);
+		}
+		query_games = QUERY_MAX_GAMES;
+	}
+	query_words = (query_games + QUERY_WORD_BITS - 1) / QUERY_WORD_BITS;
+	if (query_words == 0){
+		query_words = 1;
+	}
+	
+	query_order = (unsigned int *) calloc(query_games + 1, sizeof(unsigned int));
+	query_all = query_NewBitset();
+	query_result = query_NewBitset();
+	query_scratch = query_NewBitset();
+	query_keywords_size = getKeywordCount();
+	status = ((query_order == NULL) || (query_all == NULL) || (query_result == NULL) || (query_scratch == NULL));
+	for(i = 0; i < QUERY_FACETS; i++){
+		query_keywords[i] = (qword_t **) calloc(query_keywords_size, sizeof(qword_t *));
+		counts[i] = (unsigned int *) calloc(query_keywords_size, sizeof(unsigned int));
+		if ((query_keywords[i] == NULL) || (counts[i] == NULL)){
+			status = 1;
+		}
+	}
+	
+	// Count the games with each facet value first, so that every posting
+	// can be allocated at its final size, as either a list or a bitset
+	memset(hw_counts, 0, sizeof(hw_counts));
+	pos = 0;
+	gamedata = gamedata_head;
+	while((status == QUERY_OK) && (gamedata != NULL) && (pos < query_games)){
+		meta = NULL;
+		if (gamedata->has_dat){
+			meta = getMetadata(gamedata, filterdat);
+		}
+		if (meta != NULL){
+			query_Count(counts[QUERY_GENRE], meta->genre, KEYWORD_NONE);
+			query_Count(counts[QUERY_SERIES], meta->series, KEYWORD_NONE);
+			query_Count(counts[QUERY_COMPANY], meta->publisher, KEYWORD_NONE);
+			query_Count(counts[QUERY_COMPANY], meta->developer, meta->publisher);
+			for(i = 0; i < QUERY_HW_BITS; i++){
+				bit = 1UL << i;
+				if (meta->hardware & bit){
+					hw_counts[i]++;
+				}
+			}
+		}
+		pos++;
+		gamedata = gamedata->next;
+	}
+	if (status == QUERY_OK){
+		for(i = 0; i < QUERY_FACETS; i++){
+			status |= query_NewPostings(query_keywords[i], counts[i], query_keywords_size);
+		}
+		status |= query_NewPostings(query_hardware_bits, hw_counts, QUERY_HW_BITS);
+	}
+	
+	// Then add each game to the posting of every facet value it has
+	pos = 0;
+	gamedata = gamedata_head;
+	while((status == QUERY_OK) && (gamedata != NULL) && (pos < query_games)){
+		query_order[pos] = gamedata->gameid;
+		query_all[pos / QUERY_WORD_BITS] |= ((qword_t) 1 << (pos % QUERY_WORD_BITS));
+	
+		meta = NULL;
+		if (gamedata->has_dat){
+			meta = getMetadata(gamedata, filterdat);
+		}
+		if (meta != NULL){
+			query_Add(query_keywords[QUERY_GENRE], counts[QUERY_GENRE], meta->genre, KEYWORD_NONE, pos);
+			query_Add(query_keywords[QUERY_SERIES], counts[QUERY_SERIES], meta->series, KEYWORD_NONE, pos);
+			query_Add(query_keywords[QUERY_COMPANY], counts[QUERY_COMPANY], meta->publisher, KEYWORD_NONE, pos);
+			query_Add(query_keywords[QUERY_COMPANY], counts[QUERY_COMPANY], meta->developer, meta->publisher, pos);
+			for(i = 0; i < QUERY_HW_BITS; i++){
+				bit = 1UL << i;
+				if (meta->hardware & bit){
+					query_AddPosition(query_hardware_bits[i], hw_counts[i], pos);
+				}
+			}
+		}
+		pos++;
+		gamedata = gamedata->next;
+	}
+	
+	for(i = 0; i < QUERY_FACETS; i++){
+		if (counts[i] != NULL){
+			free(counts[i]);
+		}
+	}
+	if (status != QUERY_OK){
+		if (QUERY_VERBOSE){
+			printf("%s.%d\t Unable to allocate memory for query postings\n", __FILE__, __LINE__);
+		}
+		query_Free();
+		return QUERY_ERR;
+	}
+	
+	if (QUERY_VERBOSE){
+		printf("%s.%d\t Built query postings for %d games, %d words in each bitset, %u keywords\n", __FILE__, __LINE__, query_games, query_words, query_keywords_size);
+	}
+	return QUERY_OK;
+}
+
+void query_Clear(){
+	// Remove all terms from the query, so that it matches every game
+	
+	int i;
+	
+	for(i = 0; i < QUERY_FACETS; i++){
+		query_nterms[i] = 0;
+		query_last_nterms[i] = 0;
+	}
+	query_hardware = 0;
+	query_last_hardware = 0;
+}
+
+void query_ClearFacet(int facet){
+	// Remove all keywords of one facet from the query
+	
+	if ((facet >= 0) && (facet < QUERY_FACETS)){
+		query_nterms[facet] = 0;
+	}
+}
+
+int query_AddKeyword(int facet, unsigned short id){
+	// Add a keyword to one facet of the query. Games matching any keyword of the
+	// facet are included; each facet with keywords set must match.
+	
+	if ((facet < 0) || (facet >= QUERY_FACETS)){
+		return QUERY_ERR;
+	}
+	if (query_nterms[facet] >= QUERY_TERMS){
+		if (QUERY_VERBOSE){
+			printf("%s.%d\t Warning - No room for keyword %u in facet %d\n", __FILE__, __LINE__, id, facet);
+		}
+		return QUERY_ERR;
+	}
+	query_terms[facet][query_nterms[facet]] = id;
+	query_nterms[facet]++;
+	return QUERY_OK;
+}
+
+void query_SetHardware(hwdata_t mask){
+	// Set the tech specs which games must all have
+	
+	query_hardware = mask;
+}
+
+static void query_Combine(int skip, hwdata_t hardware){
+	// Combine the postings of every keyword term of the query, except those of facet skip,
+	// and of the given tech specs, leaving the games that match in query_result.
+	
+	int f;
+	int t;
+	int w;
+	unsigned int i;
+	qword_t *posting = NULL;
+	
+	memcpy(query_result, query_all, query_words * sizeof(qword_t));
+	
+	// Keyword facets; OR within a facet, AND between them
+	for(f = 0; f < QUERY_FACETS; f++){
+		if ((f != skip) && (query_nterms[f] > 0)){
+			memset(query_scratch, 0, query_words * sizeof(qword_t));
+			for(t = 0; t < query_nterms[f]; t++){
+				if (query_terms[f][t] < query_keywords_size){
+					posting = query_keywords[f][query_terms[f][t]];
+					if (posting != NULL){
+						query_Or(query_scratch, posting);
+					}
+				}
+			}
+			for(w = 0; w < query_words; w++){
+				query_result[w] &= query_scratch[w];
+			}
+		}
+	}
+	
+	// Tech specs; every one selected must be present
+	for(i = 0; i < QUERY_HW_BITS; i++){
+		if (hardware & (1UL << i)){
+			posting = query_hardware_bits[i];
+			if (posting == NULL){
+				// No game has this capability
+				memset(query_result, 0, query_words * sizeof(qword_t));
+				break;
+			}
+			memset(query_scratch, 0, query_words * sizeof(qword_t));
+			query_Or(query_scratch, posting);
+			for(w = 0; w < query_words; w++){
+				query_result[w] &= query_scratch[w];
+			}
+		}
+	}
+}
+
+static unsigned int query_CountBits(qword_t *posting){
+	// Count the games in query_result, and also in posting unless it is NULL
+	
+	int w;
+	unsigned int i;
+	unsigned int n;
+	qword_t word;
+	qword_t pos;
+	
+	n = 0;
+	if ((posting != NULL) && query_IsList(posting[0])){
+		for(i = 1; i <= posting[0]; i++){
+			pos = posting[i];
+			if (query_result[pos / QUERY_WORD_BITS] & ((qword_t) 1 << (pos % QUERY_WORD_BITS))){
+				n++;
+			}
+		}
+		return n;
+	}
+	for(w = 0; w < query_words; w++){
+		word = query_result[w];
+		if (posting != NULL){
+			word &= posting[w + 1];
+		}
+		while(word != 0){
+			word &= word - 1;
+			n++;
+		}
+	}
+	return n;
+}
+
+int query_Run(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat){
+	// Combine the postings of every term of the query and fill the selection list
+	// with the matching games, in sorted order. If there isn't the memory to do so,
+	// the selection list is left as it was, along with the query that filled it.
+	
+	int w;
+	unsigned int i;
+	int pos;
+	qword_t word;
+	
+	if (query_Build(gamedata, filterdat) != QUERY_OK){
+		if (QUERY_VERBOSE){
+			printf("%s.%d\t Error - Unable to run query, keeping the previous selection\n", __FILE__, __LINE__);
+		}
+		memcpy(query_terms, query_last_terms, sizeof(query_terms));
+		memcpy(query_nterms, query_last_nterms, sizeof(query_nterms));
+		query_hardware = query_last_hardware;
+		return QUERY_ERR;
+	}
+	
+	query_Combine(-1, query_hardware);
+	
+	// Count the matches first, so the selection list can be sized to fit them
+	query_SelectionSize(state, query_CountBits(NULL));
+	
+	// Empty list
+	for(i =0; i <state->selected_size; i++){
+		state->selected_list[i] = -1;
+	}
+	
+	// Bit positions are in sorted order, so the selection list is too
+	i = 0;
+	for(w = 0; (w < query_words) && (i < state->selected_size); w++){
+		word = query_result[w];
+		pos = w * QUERY_WORD_BITS;
+		while((word != 0) && (i < state->selected_size)){
+			if (word & 1){
+				if (QUERY_VERBOSE){
+					printf("%s.%d\t Info - adding Game ID: [%d]\n", __FILE__, __LINE__, query_order[pos]);
+				}
+				state->selected_list[i] = query_order[pos];
+				i++;
+			}
+			word >>= 1;
+			pos++;
+		}
+	}
+	if (QUERY_VERBOSE){
+		printf("%s.%d\t Total of %d games matched\n", __FILE__, __LINE__, i);
+	}
+	
+	state->selected_max = i; 	// Number of items in selection list
+	state->selected_page = 1;	// Start on page 1
+	state->selected_line = 0;	// Start on line 0
+	state->selected_filter_string = 0;
+	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
+	state->selected_game = getGameid(state->selected_gameid, gamedata);
+	query_SelectionPages(state);
+	search_IndexPrefix(state, gamedata);
+	
+	memcpy(query_last_terms, query_terms, sizeof(query_terms));
+	memcpy(query_last_nterms, query_nterms, sizeof(query_nterms));
+	query_last_hardware = query_hardware;
+	return QUERY_OK;
+}
+
+int query_CountKeywords(int facet, gamedata_t *gamedata, launchdat_t *filterdat){
+	// Get ready to count, with query_KeywordCount(), how many games each keyword of a facet
+	// would match. Picking a keyword replaces any already chosen for its facet, so the
+	// count is against every other term of the query, including the tech specs.
+	
+	if (query_Build(gamedata, filterdat) != QUERY_OK){
+		return QUERY_ERR;
+	}
+	query_Combine(facet, query_hardware);
+	return QUERY_OK;
+}
+
+unsigned int query_KeywordCount(int facet, unsigned short id){
+	// Returns the number of games a keyword would match, after query_CountKeywords()
+	
+	if ((query_all == NULL) || (facet < 0) || (facet >= QUERY_FACETS) || (id >= query_keywords_size)){
+		return 0;
+	}
+	if (query_keywords[facet][id] == NULL){
+		return 0;
+	}
+	return query_CountBits(query_keywords[facet][id]);
+}
+
+int query_CountHardware(hwdata_t hardware, gamedata_t *gamedata, launchdat_t *filterdat){
+	// Get ready to count, with query_HardwareCount(), how many games each tech spec would
+	// match if it was added to those given. Every keyword term of the query still applies.
+	
+	if (query_Build(gamedata, filterdat) != QUERY_OK){
+		return QUERY_ERR;
+	}
+	query_Combine(-1, hardware);
+	return QUERY_OK;
+}
+
+unsigned int query_HardwareCount(hwdata_t mask){
+	// Returns the number of games with a tech spec capability bit, after query_CountHardware()
+	
+	int i;
+	
+	if (query_all == NULL){
+		return 0;
+	}
+	for(i = 0; i < QUERY_HW_BITS; i++){
+		if (mask & (1UL << i)){
+			if (query_hardware_bits[i] == NULL){
+				return 0;
+			}
+			return query_CountBits(query_hardware_bits[i]);
+		}
+	}
+	return 0;
+}
+
+int query_SelectionSize(state_t *state, unsigned int items){
+	// Grow or shrink the selection list to hold a number of games, rounded up to a whole
+	// block so that a few games more or less don't each need a realloc. Entries are 16bit
+	// gameids, so even the largest list is a single far heap allocation of under 64KB.
+	// If the list can't be grown it keeps its old size, and callers fill only that much.
+	
+	unsigned int size;
+	unsigned int *list = NULL;
+	
+	if (items > SELECTION_LIST_MAX){
+		if (QUERY_VERBOSE){
+			printf("%s.%d\t Warning - Only the first %d of %u games can be listed\n", __FILE__, __LINE__, SELECTION_LIST_MAX, items);
+		}
+		items = SELECTION_LIST_MAX;
+	}
+	
+	// Always at least one block, so the first entry can be read even when nothing matched
+	size = (items / SELECTION_LIST_BLOCK) * SELECTION_LIST_BLOCK;
+	if ((size < items) || (size == 0)){
+		if (size < (SELECTION_LIST_MAX - SELECTION_LIST_BLOCK)){
+			size += SELECTION_LIST_BLOCK;
+		} else {
+			size = SELECTION_LIST_MAX;
+		}
+	}
+	if (size == state->selected_size){
+		return QUERY_OK;
+	}
+	
+	list = (unsigned int *) realloc(state->selected_list, size * sizeof(unsigned int));
+	if (list == NULL){
+		if (QUERY_VERBOSE){
+			printf("%s.%d\t Error - Unable to allocate a selection list of %u entries\n", __FILE__, __LINE__, size);
+		}
+		return QUERY_ERR;
+	}
+	state->selected_list = list;
+	state->selected_size = size;
+	return QUERY_OK;
+}
+
+void query_SelectionPages(state_t *state){
+	// Work out how many pages of the game browser the selection list fills; always at least one
+	
+	state->total_pages = (state->selected_max + ui_browser_max_lines - 1) / ui_browser_max_lines;
+	if (state->total_pages == 0){
+		state->total_pages = 1;
+	}
+}
+
+unsigned long query_Bytes(state_t *state){
+	// Returns the bytes allocated for the selection list and, if they have been built, the postings
+	
+	unsigned long bytes;
+	unsigned int id;
+	int i;
+	
+	bytes = (unsigned long) state->selected_size * sizeof(unsigned int);
+	if (query_all == NULL){
+		return bytes;
+	}
+	
+	bytes += (unsigned long) (query_games + 1) * sizeof(unsigned int);
+	bytes += 3 * (unsigned long) query_words * sizeof(qword_t);
+	for(i = 0; i < QUERY_FACETS; i++){
+		if (query_keywords[i] != NULL){
+			bytes += (unsigned long) query_keywords_size * sizeof(qword_t *);
+			for(id = 0; id < query_keywords_size; id++){
+				if (query_keywords[i][id] != NULL){
+					bytes += query_PostingBytes(query_keywords[i][id]);
+				}
+			}
+		}
+	}
+	for(i = 0; i < QUERY_HW_BITS; i++){
+		if (query_hardware_bits[i] != NULL){
+			bytes += query_PostingBytes(query_hardware_bits[i]);
+		}
+	}
+	return bytes;
+}
+
+void query_Free(){
+	// Free all of the postings and bitsets, they will be rebuilt on the next query
+	
+	unsigned int id;
+	int i;
+	
+	for(i = 0; i < QUERY_FACETS; i++){
+		if (query_keywords[i] != NULL){
+			for(id = 0; id < query_keywords_size; id++){
+				if (query_keywords[i][id] != NULL){
+					free(query_keywords[i][id]);
+				}
+			}
+			free(query_keywords[i]);
+			query_keywords[i] = NULL;
+		}
+	}
+	for(i = 0; i < QUERY_HW_BITS; i++){
+		if (query_hardware_bits[i] != NULL){
+			free(query_hardware_bits[i]);
+			query_hardware_bits[i] = NULL;
+		}
+	}
+	if (query_order != NULL){
+		free(query_order);
+		query_order = NULL;
+	}
+	if (query_all != NULL){
+		free(query_all);
+		query_all = NULL;
+	}
+	if (query_result != NULL){
+		free(query_result);
+		query_result = NULL;
+	}
+	if (query_scratch != NULL){
+		free(query_scratch);
+		query_scratch = NULL;
+	}
+	query_keywords_size = 0;
+	query_games = 0;
+	query_words = 0;
+}
@@ -0,0 +1,59 @@
+/* query.h, Combined genre, series, company and tech spec filtering for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#ifndef __HAS_MAIN
+#include "main.h"
+#define __HAS_MAIN
+#endif
+
+// Defaults
+#define QUERY_VERBOSE		0			// Enable/disable logging for these functions
+#define QUERY_OK				0			// Success returncode
+#define QUERY_ERR			-1			// Failure returncode
+#define QUERY_MAX_GAMES		16384		// Most games that can be filtered; keeps the sort order table under 64KB
+#define QUERY_TERMS			8			// Most keywords that can be OR'ed together within one facet
+#define QUERY_HW_BITS		32			// Number of bits in hwdata_t
+
+// Keyword facets; tech specs are kept separately as a hardware mask
+#define QUERY_GENRE			0
+#define QUERY_SERIES			1
+#define QUERY_COMPANY		2
+#define QUERY_FACETS			3
+
+// One bit per game, in sorted list order
+typedef unsigned int qword_t;
+#define QUERY_WORD_BITS		(sizeof(qword_t) * 8)
+
+// Function prototypes
+int		query_Build(gamedata_t *gamedata, launchdat_t *filterdat);
+void	query_Clear();
+void	query_ClearFacet(int facet);
+int		query_AddKeyword(int facet, unsigned short id);
+void	query_SetHardware(hwdata_t mask);
+int		query_Run(state_t *state, gamedata_t *gamedata, launchdat_t *filterdat);
+int		query_CountKeywords(int facet, gamedata_t *gamedata, launchdat_t *filterdat);
+unsigned int	query_KeywordCount(int facet, unsigned short id);
+int		query_CountHardware(hwdata_t hardware, gamedata_t *gamedata, launchdat_t *filterdat);
+unsigned int	query_HardwareCount(hwdata_t mask);
+void	query_Free();
+int		query_SelectionSize(state_t *state, unsigned int items);
+void	query_SelectionPages(state_t *state);
+unsigned long	query_Bytes(state_t *state);
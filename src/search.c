@@ -0,0 +1,528 @@
+/* search.c, Finding games by name in the browser list for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#ifndef __HAS_MAIN
+#include "main.h"
+#define __HAS_MAIN
+#endif
+#include "names.h"
+#include "query.h"
+#include "search.h"
+#include "timers.h"
+#include "ui.h"
+
+// Position in the selection list of the first name starting with each character,
+// the names of a bucket run up to the start of the next one. Rebuilt whenever the
+// selection list changes, so typing a name is only ever a binary search.
+static unsigned int search_buckets[SEARCH_BUCKETS + 1];
+
+// Characters typed so far, and when the last one was typed
+static char search_typed[MAX_NAME_SIZE];
+static int search_typed_len = 0;
+static clock_t search_typed_last = 0;
+
+// Bigram index of every name. Each posting list holds the positions, in the sorted game list,
+// of the names containing that pair of characters, in ascending order.
+static unsigned int search_games = 0;								// Number of games in the index
+static unsigned int *search_order = NULL;							// Gameid of the game at each position
+static unsigned int *search_matches = NULL;						// Working list of positions while searching
+static unsigned int *search_postings[SEARCH_BIGRAMS];				// Posting list of each bigram
+static unsigned int search_postings_size[SEARCH_BIGRAMS];			// Length of each posting list
+static unsigned int search_moved = 0;								// names_Moved() when the index was built
+
+// Selection list from before the search pane was opened, put back if the search is cancelled
+static unsigned int *search_saved_list = NULL;
+static unsigned int search_saved_max;
+static unsigned int search_saved_page;
+static unsigned char search_saved_line;
+static unsigned int search_saved_pages;
+static int search_saved_gameid;
+
+static char * search_Name(state_t *state, gamedata_t *gamedata, unsigned int pos){
+	// Name of the game at a position of the selection list
+	
+	gamedata_t *game = NULL;
+	
+	game = getGameid(state->selected_list[pos], gamedata);
+	if (game == NULL){
+		return "";
+	}
+	return game->name;
+}
+
+static int search_ComparePrefix(char *name, char *prefix){
+	// Compare the start of a name with a prefix, ignoring case, in the same order as sortGamedata()
+	
+	int cn, cp;
+	
+	while (*prefix != '\0'){
+		cn = toupper((unsigned char) *name);
+		cp = toupper((unsigned char) *prefix);
+		if (cn != cp){
+			return cn - cp;
+		}
+		name++;
+		prefix++;
+	}
+	return 0;
+}
+
+int search_IndexPrefix(state_t *state, gamedata_t *gamedata){
+	// Build the first character buckets of the current selection list. Must be called
+	// again whenever the selection list changes.
+	// The selection list is always in sorted order, so this is one pass over it.
+	
+	unsigned int pos;
+	int c;
+	
+	pos = 0;
+	for(c = 0; c < SEARCH_BUCKETS; c++){
+		while ((pos < state->selected_max) && (toupper((unsigned char) search_Name(state, gamedata, pos)[0]) < c)){
+			pos++;
+		}
+		search_buckets[c] = pos;
+	}
+	search_buckets[SEARCH_BUCKETS] = state->selected_max;
+	
+	if (SEARCH_VERBOSE){
+		printf("%s.%d\t Indexed first characters of %d games\n", __FILE__, __LINE__, state->selected_max);
+	}
+	return SEARCH_OK;
+}
+
+int search_Prefix(state_t *state, gamedata_t *gamedata, char *prefix){
+	// Return the position in the selection list of the first name starting with
+	// a prefix, or of the name it would sort before if there is no such name.
+	// The first character picks a bucket, the rest is a binary search within it.
+	
+	unsigned int low;
+	unsigned int high;
+	unsigned int mid;
+	int c;
+	
+	if (state->selected_max == 0){
+		return SEARCH_ERR;
+	}
+	
+	c = toupper((unsigned char) prefix[0]);
+	low = search_buckets[c];
+	high = search_buckets[c + 1];
+	
+	// Lowest position in the bucket which is not before the prefix
+	while (low < high){
+		mid = low + ((high - low) / 2);
+		if (search_ComparePrefix(search_Name(state, gamedata, mid), prefix) < 0){
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	
+	// Past the end of the list, settle for the last game
+	if (low >= state->selected_max){
+		low = state->selected_max - 1;
+	}
+	
+	if (SEARCH_VERBOSE){
+		printf("%s.%d\t Prefix [%s] found at %u, %s\n", __FILE__, __LINE__, prefix, low, search_Name(state, gamedata, low));
+	}
+	return (int) low;
+}
+
+int search_TypeAhead(state_t *state, gamedata_t *gamedata, int c){
+	// Add a character to the name being typed and move the browser selection to the first
+	// game starting with it. Typing after a pause starts a new name. A backspace removes
+	// the last character typed.
+	
+	int pos;
+	unsigned int page;
+	
+	if (timers_TypeAheadExpired(search_typed_last)){
+		search_typed_len = 0;
+	}
+	search_typed_last = clock();
+	
+	if (c == '\b'){
+		if (search_typed_len > 0){
+			search_typed_len--;
+		}
+		if (search_typed_len == 0){
+			return SEARCH_ERR;
+		}
+	} else {
+		// Names don't start with a space
+		if ((c == ' ') && (search_typed_len == 0)){
+			return SEARCH_ERR;
+		}
+		if (search_typed_len >= (MAX_NAME_SIZE - 1)){
+			return SEARCH_ERR;
+		}
+		search_typed[search_typed_len] = (char) c;
+		search_typed_len++;
+	}
+	search_typed[search_typed_len] = '\0';
+	
+	pos = search_Prefix(state, gamedata, search_typed);
+	if (pos < 0){
+		return SEARCH_ERR;
+	}
+	
+	page = (pos / ui_browser_max_lines) + 1;
+	if (page != state->selected_page){
+		state->page_changed = 1;
+	}
+	state->selected_page = page;
+	state->selected_line = pos % ui_browser_max_lines;
+	state->selected_gameid = state->selected_list[pos];
+	
+	if (SEARCH_VERBOSE){
+		printf("%s.%d\t Type-ahead [%s] moved to page %d, line %d\n", __FILE__, __LINE__, search_typed, state->selected_page, state->selected_line);
+	}
+	return SEARCH_OK;
+}
+
+void search_TypeAheadReset(){
+	// Forget the name being typed, the next character starts a new one
+	
+	search_typed_len = 0;
+}
+
+static int search_Symbol(char c){
+	// Fold a character into the alphabet of the bigram index
+	
+	c = toupper((unsigned char) c);
+	if ((c >= 'A') && (c <= 'Z')){
+		return c - 'A';
+	}
+	if ((c >= '0') && (c <= '9')){
+		return 26 + (c - '0');
+	}
+	return SEARCH_ALPHABET - 1;
+}
+
+static int search_Bigrams(char *text, unsigned int *bigrams){
+	// Fill an array with each distinct bigram of a string, returning how many there are.
+	// The array must have room for one less than the length of the string.
+	
+	int i;
+	int n;
+	int b;
+	unsigned int bigram;
+	
+	n = 0;
+	for(i = 0; (text[i] != '\0') && (text[i + 1] != '\0'); i++){
+		bigram = (search_Symbol(text[i]) * SEARCH_ALPHABET) + search_Symbol(text[i + 1]);
+		for(b = 0; b < n; b++){
+			if (bigrams[b] == bigram){
+				break;
+			}
+		}
+		if (b == n){
+			bigrams[n] = bigram;
+			n++;
+		}
+	}
+	return n;
+}
+
+static int search_Contains(char *name, char *text){
+	// Whether a name contains some text, ignoring case
+	
+	for(; *name != '\0'; name++){
+		if (search_ComparePrefix(name, text) == 0){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int search_IndexBigrams(gamedata_t *gamedata){
+	// Build the bigram index over the sorted game list. One pass counts the games
+	// for each bigram so every posting list can be allocated at its final size, a
+	// second pass fills them in.
+	
+	int i;
+	int n;
+	unsigned int pos;
+	unsigned int bigrams[MAX_NAME_SIZE];
+	gamedata_t *gamedata_head;
+	
+	if (search_order != NULL){
+		if (search_moved == names_Moved()){
+			// Already built
+			return SEARCH_OK;
+		}
+		// Built while names were still loading, and games have moved since
+		search_Free();
+	}
+	search_moved = names_Moved();
+	
+	gamedata_head = gamedata;
+	
+	memset(search_postings_size, 0, sizeof(search_postings_size));
+	search_games = 0;
+	while(gamedata != NULL){
+		n = search_Bigrams(gamedata->name, bigrams);
+		for(i = 0; i < n; i++){
+			search_postings_size[bigrams[i]]++;
+		}
+		search_games++;
+		gamedata = gamedata->next;
+	}
+	
+	search_order = (unsigned int *) calloc(search_games + 1, sizeof(unsigned int));
+	search_matches = (unsigned int *) calloc(search_games + 1, sizeof(unsigned int));
+	if ((search_order == NULL) || (search_matches == NULL)){
+		if (SEARCH_VERBOSE){
+			printf("%s.%d\t Unable to allocate memory for search index\n", __FILE__, __LINE__);
+		}
+		search_Free();
+		return SEARCH_ERR;
+	}
+	for(i = 0; i < SEARCH_BIGRAMS; i++){
+		if (search_postings_size[i] > 0){
+			search_postings[i] = (unsigned int *) malloc(search_postings_size[i] * sizeof(unsigned int));
+			if (search_postings[i] == NULL){
+				if (SEARCH_VERBOSE){
+					printf("%s.%d\t Unable to allocate memory for search index\n", __FILE__, __LINE__);
+				}
+				search_Free();
+				return SEARCH_ERR;
+			}
+		}
+		// Counted up again as the lists are filled
+		search_postings_size[i] = 0;
+	}
+	
+	pos = 0;
+	gamedata = gamedata_head;
+	while(gamedata != NULL){
+		search_order[pos] = gamedata->gameid;
+		n = search_Bigrams(gamedata->name, bigrams);
+		for(i = 0; i < n; i++){
+			search_postings[bigrams[i]][search_postings_size[bigrams[i]]] = pos;
+			search_postings_size[bigrams[i]]++;
+		}
+		pos++;
+		gamedata = gamedata->next;
+	}
+	
+	if (SEARCH_VERBOSE){
+		printf("%s.%d\t Indexed bigrams of %u games\n", __FILE__, __LINE__, search_games);
+	}
+	return SEARCH_OK;
+}
+
+int search_Open(state_t *state, gamedata_t *gamedata){
+	// Get ready to search; build the index the first time, and keep a copy of the
+	// current selection list in case the search is cancelled.
+	
+	unsigned int *saved = NULL;
+	
+	if (search_IndexBigrams(gamedata) != SEARCH_OK){
+		return SEARCH_ERR;
+	}
+	
+	// Only as much of the list as is in use is kept
+	saved = (unsigned int *) realloc(search_saved_list, (state->selected_max + 1) * sizeof(unsigned int));
+	if (saved == NULL){
+		if (SEARCH_VERBOSE){
+			printf("%s.%d\t Error - Unable to keep a copy of the selection list\n", __FILE__, __LINE__);
+		}
+		return SEARCH_ERR;
+	}
+	search_saved_list = saved;
+	memcpy(search_saved_list, state->selected_list, state->selected_max * sizeof(unsigned int));
+	search_saved_max = state->selected_max;
+	search_saved_page = state->selected_page;
+	search_saved_line = state->selected_line;
+	search_saved_pages = state->total_pages;
+	search_saved_gameid = state->selected_gameid;
+	return SEARCH_OK;
+}
+
+int search_Substring(state_t *state, gamedata_t *gamedata, char *text){
+	// Fill the selection list with every game whose name contains some text.
+	// Only names holding all of the bigrams of the text can match, so the posting
+	// lists of those are intersected, shortest first, and just the names left
+	// over are checked in full.
+	
+	int i;
+	int n;
+	int shortest;
+	unsigned int a, b, c;
+	unsigned int matches;
+	unsigned int bigrams[SEARCH_TEXT_SIZE];
+	unsigned int *postings = NULL;
+	gamedata_t *game = NULL;
+	
+	if (search_order == NULL){
+		return SEARCH_ERR;
+	}
+	
+	n = search_Bigrams(text, bigrams);
+	if (n == 0){
+		// Too short to narrow anything down, so every name is checked
+		for(a = 0; a < search_games; a++){
+			search_matches[a] = a;
+		}
+		matches = search_games;
+	} else {
+		shortest = 0;
+		for(i = 1; i < n; i++){
+			if (search_postings_size[bigrams[i]] < search_postings_size[bigrams[shortest]]){
+				shortest = i;
+			}
+		}
+		matches = search_postings_size[bigrams[shortest]];
+		if (matches > 0){
+			memcpy(search_matches, search_postings[bigrams[shortest]], matches * sizeof(unsigned int));
+		}
+		
+		// Both lists are in ascending order, so each intersection is a single merge
+		for(i = 0; (i < n) && (matches > 0); i++){
+			if (i == shortest){
+				continue;
+			}
+			postings = search_postings[bigrams[i]];
+			a = 0;
+			b = 0;
+			c = 0;
+			while((a < matches) && (b < search_postings_size[bigrams[i]])){
+				if (search_matches[a] < postings[b]){
+					a++;
+				} else if (search_matches[a] > postings[b]){
+					b++;
+				} else {
+					search_matches[c] = search_matches[a];
+					c++;
+					a++;
+					b++;
+				}
+			}
+			matches = c;
+		}
+	}
+	
+	// Room for everything which might match, cut down to what did once the names are checked
+	query_SelectionSize(state, matches);
+	for(c =0; c <state->selected_size; c++){
+		state->selected_list[c] = -1;
+	}
+	
+	c = 0;
+	for(a = 0; (a < matches) && (c < state->selected_size); a++){
+		// Bigrams can match in a different order to the text, so check the whole name
+		game = getGameid(search_order[search_matches[a]], gamedata);
+		if ((game != NULL) && ((text[0] == '\0') || search_Contains(game->name, text))){
+			state->selected_list[c] = game->gameid;
+			c++;
+		}
+	}
+	
+	if (SEARCH_VERBOSE){
+		printf("%s.%d\t Search [%s] checked %u names, %u matched\n", __FILE__, __LINE__, text, matches, c);
+	}
+	
+	query_SelectionSize(state, c);
+	state->selected_max = c; 	// Number of items in selection list
+	state->selected_page = 1;	// Start on page 1
+	state->selected_line = 0;	// Start on line 0
+	state->selected_gameid = state->selected_list[0]; 	// Initial game is the 0th element of the selection list
+	state->selected_game = getGameid(state->selected_gameid, gamedata);
+	query_SelectionPages(state);
+	search_IndexPrefix(state, gamedata);
+	return SEARCH_OK;
+}
+
+int search_Cancel(state_t *state, gamedata_t *gamedata){
+	// Put back the selection list from before the search pane was opened
+	
+	if (search_saved_list == NULL){
+		return SEARCH_ERR;
+	}
+	if (query_SelectionSize(state, search_saved_max) != QUERY_OK){
+		return SEARCH_ERR;
+	}
+	memcpy(state->selected_list, search_saved_list, search_saved_max * sizeof(unsigned int));
+	free(search_saved_list);
+	search_saved_list = NULL;
+	state->selected_max = search_saved_max;
+	state->selected_page = search_saved_page;
+	state->selected_line = search_saved_line;
+	state->total_pages = search_saved_pages;
+	state->selected_gameid = search_saved_gameid;
+	state->selected_game = getGameid(state->selected_gameid, gamedata);
+	search_IndexPrefix(state, gamedata);
+	return SEARCH_OK;
+}
+
+unsigned long search_Bytes(){
+	// Returns the bytes allocated for the bigram index and any saved selection list
+	
+	unsigned long bytes;
+	int i;
+	
+	bytes = 0;
+	if (search_order != NULL){
+		bytes += 2 * (unsigned long) (search_games + 1) * sizeof(unsigned int);
+		for(i = 0; i < SEARCH_BIGRAMS; i++){
+			bytes += (unsigned long) search_postings_size[i] * sizeof(unsigned int);
+		}
+	}
+	if (search_saved_list != NULL){
+		bytes += (unsigned long) (search_saved_max + 1) * sizeof(unsigned int);
+	}
+	return bytes;
+}
+
+void search_Free(){
+	// Free the bigram index, it will be rebuilt the next time the search pane is opened
+	
+	int i;
+	
+	for(i = 0; i < SEARCH_BIGRAMS; i++){
+		if (search_postings[i] != NULL){
+			free(search_postings[i]);
+			search_postings[i] = NULL;
+		}
+		search_postings_size[i] = 0;
+	}
+	if (search_order != NULL){
+		free(search_order);
+		search_order = NULL;
+	}
+	if (search_matches != NULL){
+		free(search_matches);
+		search_matches = NULL;
+	}
+	if (search_saved_list != NULL){
+		free(search_saved_list);
+		search_saved_list = NULL;
+	}
+	search_games = 0;
+}
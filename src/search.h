@@ -0,0 +1,45 @@
+/* search.h, Finding games by name in the browser list for x86Launcher.
+ Copyright (C) 2020  John Snowdon
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __HAS_DATA
+#include "data.h"
+#define __HAS_DATA
+#endif
+#ifndef __HAS_MAIN
+#include "main.h"
+#define __HAS_MAIN
+#endif
+
+// Defaults
+#define SEARCH_VERBOSE		0			// Enable/disable logging for these functions
+#define SEARCH_OK			0			// Success returncode
+#define SEARCH_ERR			-1			// Failure returncode, or nothing found
+#define SEARCH_BUCKETS		256			// One bucket per (upper case) first character of a name
+#define SEARCH_ALPHABET		37			// Characters told apart by the bigram index; A-Z, 0-9 and anything else
+#define SEARCH_BIGRAMS		(SEARCH_ALPHABET * SEARCH_ALPHABET)
+#define SEARCH_TEXT_SIZE		32			// Longest text that can be searched for
+
+// Function prototypes
+int		search_IndexPrefix(state_t *state, gamedata_t *gamedata);
+int		search_Prefix(state_t *state, gamedata_t *gamedata, char *prefix);
+int		search_TypeAhead(state_t *state, gamedata_t *gamedata, int c);
+void	search_TypeAheadReset();
+int		search_Open(state_t *state, gamedata_t *gamedata);
+int		search_Substring(state_t *state, gamedata_t *gamedata, char *text);
+int		search_Cancel(state_t *state, gamedata_t *gamedata);
+void	search_Free();
+unsigned long	search_Bytes();
@@ -20,10 +20,42 @@
 
 #include "timers.h"
 
+static FILE *timers_log = NULL;			// Open while timings go to TIMERS_LOG rather than the console
+
+void timers_Log(int enabled){
+	// Write timings to TIMERS_LOG instead of the console, or go back to the console.
+	// Console output goes through the BIOS, which in graphics mode draws straight into
+	// video memory, and may switch the memory window without the flip code knowing.
+	
+	if (enabled && (timers_log == NULL)){
+		timers_log = fopen(TIMERS_LOG, "w");
+	}
+	if (!enabled && (timers_log != NULL)){
+		fclose(timers_log);
+		timers_log = NULL;
+	}
+}
+
+FILE * timers_Out(){
+	// Returns where timings are written to, the log if it is open or the console
+	
+	if (timers_log != NULL){
+		return timers_log;
+	}
+	return stdout;
+}
+
 void timers_Print(clock_t start, clock_t end, char* name, int enabled){
 	
 	if (enabled){
-		printf("%s.%d\t %-30s: %5d ticks\n", __FILE__, __LINE__, name, (end - start));
+		fprintf(timers_Out(), "%s.%d\t %-30s: %5ld ticks\n", __FILE__, __LINE__, name, (long int) (end - start));
+	}
+}
+
+void timers_PrintBytes(unsigned long bytes, char* name, int enabled){
+	
+	if (enabled){
+		fprintf(timers_Out(), "%s.%d\t %-30s: %5lu bytes\n", __FILE__, __LINE__, name, bytes);
 	}
 }
 
@@ -33,7 +65,8 @@ int timers_FireArt(clock_t last){
 	
 	long int t;
 	
-	t = clock() - last;
+	// Clock ticks are milliseconds under DOS, but not on every host
+	t = (clock() - last) / (CLOCKS_PER_SEC / 1000);
 	
 	if (t > ARTWORK_FIRE){
 		return 1;
@@ -42,3 +75,18 @@ int timers_FireArt(clock_t last){
 	}
 }
 
+
+int timers_TypeAheadExpired(clock_t last){
+	// Returns true if the timeout since the last character typed
+	// has exceeded that to start typing a new name
+	
+	long int t;
+	
+	t = (clock() - last) / (CLOCKS_PER_SEC / 1000);
+	
+	if (t > TYPEAHEAD_FIRE){
+		return 1;
+	} else {
+		return 0;	
+	}
+}
@@ -1,5 +1,11 @@
 
 #define ARTWORK_FIRE		500		// Artwork display fires after this amount of timeout after the last user input
+#define TYPEAHEAD_FIRE		1000	// Typing a name after this amount of timeout after the last character starts a new one
+#define TIMERS_LOG			"timers.log"	// Timings are written here instead of the screen while in graphics mode
 
+void timers_Log(int enabled);
+FILE * timers_Out();
 void timers_Print(clock_t start, clock_t end, char* name, int enabled);
+void timers_PrintBytes(unsigned long bytes, char* name, int enabled);
 int timers_FireArt(clock_t last);
+int timers_TypeAheadExpired(clock_t last);
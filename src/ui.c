@@ -36,6 +36,7 @@
 #include "palette.h"
 #define __HAS_PAL
 #endif
+#include "platform.h"
 
 // bmpdata_t structures are needed permanently for all ui 
 // bitmap elements, as we may need to repaint the screen at
@@ -120,7 +121,7 @@ void ui_Close(){
 	if (UI_VERBOSE){
 		printf("%s.%d\t ui_Close() Closing file handles\n", __FILE__, __LINE__);
 	}
-	fclose(ui_asset_reader);
+	// Small assets are closed as soon as they are read, only the main background stays open
 	fclose(ui_mainstate_reader);
 	
 	if (UI_VERBOSE){
@@ -132,7 +133,8 @@ int ui_DisplayArtwork(FILE *screenshot_file, bmpdata_t *screenshot_bmp, bmpstate
 
 	int status;
 	int has_screenshot;
-	char msg[65];
+	char msg[MAX_IMAGEPATH_SIZE];
+	char game_path[MAX_GAMEPATH_SIZE];
 	
 	// Restart artwork display
 	// =======================
@@ -146,8 +148,13 @@ int ui_DisplayArtwork(FILE *screenshot_file, bmpdata_t *screenshot_bmp, bmpstate
 	// Clear artwork window
 	gfx_BoxFill(ui_artwork_xpos, ui_artwork_ypos, ui_artwork_xpos + ui_artwork_width, ui_artwork_ypos + ui_artwork_height, PALETTE_UI_BLACK);
 	
+	// Nothing more to do for a game without any artwork
+	if (imagefile->selected < 0){
+		return UI_OK;
+	}
+	
 	// Construct full path of image
-	sprintf(msg, "%s\\%s", state->selected_game->path, imagefile->filename[imagefile->selected]);
+	sprintf(msg, "%s\\%s", getGamePath(state->selected_game, game_path), imagefile->filename[imagefile->selected]);
 	strcpy(state->selected_image, msg);
 	if (UI_VERBOSE){
 		printf("%s.%d\t ui_DisplayArtwork() Selected artwork [%d] filename [%s]\n", __FILE__, __LINE__, imagefile->selected, imagefile->filename[imagefile->selected]);
@@ -159,7 +166,7 @@ int ui_DisplayArtwork(FILE *screenshot_file, bmpdata_t *screenshot_bmp, bmpstate
 	if (UI_VERBOSE){
 		printf("%s.%d\t ui_DisplayArtwork() Opening artwork file\n", __FILE__, __LINE__);	
 	}
-	screenshot_file = fopen(state->selected_image, "rb");
+	screenshot_file = platform_Open(state->selected_image, "rb");
 	if (screenshot_file == NULL){
 		if (UI_VERBOSE){
 			printf("%s.%d\t ui_DisplayArtwork() Error, unable to open artwork file\n", __FILE__, __LINE__);	
@@ -178,7 +185,7 @@ int ui_DisplayArtwork(FILE *screenshot_file, bmpdata_t *screenshot_bmp, bmpstate
 		has_screenshot = 1;	
 		if (has_screenshot){
 			screenshot_state->rows_remaining = screenshot_bmp->height;
-			status = gfx_BitmapAsyncFull(ui_artwork_xpos + ((ui_artwork_width - screenshot_bmp->width) / 2) , ui_artwork_ypos + ((ui_artwork_height - screenshot_bmp->height) / 2), screenshot_bmp, ui_asset_reader, screenshot_state, 0, 0);
+			status = gfx_BitmapAsyncFull(ui_artwork_xpos + ((ui_artwork_width - screenshot_bmp->width) / 2) , ui_artwork_ypos + ((ui_artwork_height - screenshot_bmp->height) / 2), screenshot_bmp, screenshot_file, screenshot_state, 0, 0);
 		}
 	}
 	if (UI_VERBOSE){
@@ -308,6 +315,7 @@ int ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int to
 	int page_i;
 	int status;
 	char msg[128]; // Title
+	char label[MAX_STRING_SIZE + 8]; // Filter string and count
 	
 	if (redraw == 0){
 		// Title for tech specs multi-choice filter
@@ -354,13 +362,16 @@ int ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int to
 	
 	// Loop through and print the list of choices on this page, highlighting the currently
 	// selected choice.
-	for(i=offset; i<MAXIMUM_FILTER_STRINGS; i++){
+	for(i=offset; i<max_selection; i++){
 		
 		// We may (probably are) be starting part way
 		// into the list of filter strings if we are on page > 1.
 		page_i = i - offset;
 		
 		if ((state->filter_strings[i] != NULL) && (strcmp(state->filter_strings[i], "") != 0)){
+			
+			// Keyword followed by the number of games it would match
+			sprintf(label, "%s (%u)", state->filter_strings[i], state->filter_strings_count[i]);
 		
 			// Column 1
 			if (page_i < MAXIMUM_FILTER_STRINGS_PER_COL){
@@ -378,7 +389,7 @@ int ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int to
 				}
 				// Only print the text if we are painting an entirely new window
 				if (redraw == 0){
-					gfx_Puts(70, 70 + (page_i * 25), ui_font, state->filter_strings[i]);
+					gfx_Puts(70, 70 + (page_i * 25), ui_font, label);
 				}
 			}
 			
@@ -398,7 +409,7 @@ int ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int to
 				}
 				// Only print the text if we are painting an entirely new window
 				if (redraw == 0){
-					gfx_Puts(255, 70 + ((page_i - 11) * 25), ui_font, state->filter_strings[i]);
+					gfx_Puts(255, 70 + ((page_i - 11) * 25), ui_font, label);
 				}
 			}
 			
@@ -418,7 +429,7 @@ int ui_DrawMultiChoiceFilterPopup(state_t *state, int select, int redraw, int to
 				}
 				// Only print the text if we are painting an entirely new window
 				if (redraw == 0){
-					gfx_Puts(445, 70 + ((page_i - 22) * 25), ui_font, state->filter_strings[i]);
+					gfx_Puts(445, 70 + ((page_i - 22) * 25), ui_font, label);
 				}
 			}	
 		}
@@ -442,6 +453,7 @@ int ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle){
 	int page_i;
 	int status;
 	char msg[64]; // Title
+	char label[MAX_STRING_SIZE + 8]; // Filter string and count
 	
 	// Draw drop-shadow
 	//gfx_BoxFillTranslucent(40, 50, GFX_COLS - 30, GFX_ROWS - 20, PALETTE_UI_DGREY);
@@ -515,13 +527,16 @@ int ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle){
 		
 		// Loop through and print the list of choices on this page, highlighting the currently
 		// selected choice.
-		for(i=offset; i<MAXIMUM_FILTER_STRINGS; i++){
+		for(i=offset; i<max_selection; i++){
 			
 			// We may (probably are) be starting part way
 			// into the list of filter strings if we are on page > 1.
 			page_i = i - offset;
 			
 			if ((state->filter_strings[i] != NULL) && (strcmp(state->filter_strings[i], "") != 0)){
+				
+				// Keyword followed by the number of games it would match
+				sprintf(label, "%s (%u)", state->filter_strings[i], state->filter_strings_count[i]);
 			
 				// Column 1
 				if (page_i < MAXIMUM_FILTER_STRINGS_PER_COL){
@@ -534,7 +549,7 @@ int ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle){
 					}
 					// Only print the text if we are painting an entirely new window
 					if (redraw == 0){
-						gfx_Puts(70, 70 + (page_i * 25), ui_font, state->filter_strings[i]);
+						gfx_Puts(70, 70 + (page_i * 25), ui_font, label);
 					}
 				}
 				
@@ -549,7 +564,7 @@ int ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle){
 					}
 					// Only print the text if we are painting an entirely new window
 					if (redraw == 0){
-						gfx_Puts(255, 70 + ((page_i - 11) * 25), ui_font, state->filter_strings[i]);
+						gfx_Puts(255, 70 + ((page_i - 11) * 25), ui_font, label);
 					}
 				}
 				
@@ -564,7 +579,7 @@ int ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle){
 					}
 					// Only print the text if we are painting an entirely new window
 					if (redraw == 0){
-						gfx_Puts(445, 70 + ((page_i - 22) * 25), ui_font, state->filter_strings[i]);
+						gfx_Puts(445, 70 + ((page_i - 22) * 25), ui_font, label);
 					}
 				}	
 			}
@@ -586,24 +601,45 @@ int ui_DrawHelpPopup(){
 	
 	// Key help
 	gfx_Puts(40, 45, ui_font, "Key controls:");
-	gfx_Puts(40, 65, ui_font, "- [F]      Bring up the game search/filter window");
-	gfx_Puts(40, 85, ui_font, "- [H]      Show this help text window");
-	gfx_Puts(40, 105, ui_font, "- [Q]      Quit the application");
+	gfx_Puts(40, 65, ui_font, "- [F2]     Bring up the game search/filter window");
+	gfx_Puts(40, 85, ui_font, "- [F1]     Show this help text window");
+	gfx_Puts(40, 105, ui_font, "- [F10]    Quit the application");
 	gfx_Puts(40, 125, ui_font, "- [Space]  Select a filter in a multi-select filter window");
-	gfx_Puts(40, 145, ui_font, "- [Enter]  Confirm a filter choice or launch selected gameq");
-	gfx_Puts(40, 165, ui_font, "- [Esc]    Close the current window or Cancel a selection");
+	gfx_Puts(40, 145, ui_font, "- [Enter]  Confirm a filter choice or launch selected game");
+	gfx_Puts(40, 165, ui_font, "- [/]      Search for games with some text anywhere in the name");
+	gfx_Puts(40, 185, ui_font, "- [Esc]    Close the current window or Cancel a selection");
 	
 	// Filter help
-	gfx_Puts(40, 200, ui_font, "Search/Filter:");
-	gfx_Puts(40, 220, ui_font, "You can search your list of games by [Genre], [Series], [Company] or");
-	gfx_Puts(40, 240, ui_font, "by selecting one or more [Tech Specs] such as specific sound or audio");
-	gfx_Puts(40, 260, ui_font, "device. Your games must have metadata [launch.dat] for this to work.");
+	gfx_Puts(40, 205, ui_font, "Search/Filter:");
+	gfx_Puts(40, 223, ui_font, "You can search your list of games by [Genre], [Series], [Company] or");
+	gfx_Puts(40, 241, ui_font, "by selecting one or more [Tech Specs] such as specific sound or audio");
+	gfx_Puts(40, 259, ui_font, "device. Your games must have metadata [launch.dat] for this to work.");
 	
 	// Launching help
-	gfx_Puts(40, 295, ui_font, "Game Browser:");
-	gfx_Puts(40, 315, ui_font, "[Up] & [Down] scrolls through the list of games on a page. [PageUp]");
-	gfx_Puts(40, 335, ui_font, "& [PageDown] jumps an entire page at a time. [Enter] launches the");
-	gfx_Puts(40, 355, ui_font, "currently selected game. [Left] & [Right] scrolls through artwork.");
+	gfx_Puts(40, 282, ui_font, "Game Browser:");
+	gfx_Puts(40, 300, ui_font, "[Up] & [Down] scrolls through the list of games on a page. [PageUp]");
+	gfx_Puts(40, 318, ui_font, "& [PageDown] jumps an entire page at a time. [Enter] launches the");
+	gfx_Puts(40, 336, ui_font, "currently selected game. [Left] & [Right] scrolls through artwork.");
+	gfx_Puts(40, 354, ui_font, "Type the start of a name to jump to it.");
+	
+	return UI_OK;
+}
+
+int ui_DrawSearchPopup(state_t *state, char *text){
+	// Draw the search box, with the text typed so far and how many games it matches
+	
+	char msg[64];
+	
+	// Draw main box
+	gfx_BoxFill(ui_search_popup_xpos, ui_search_popup_ypos, ui_search_popup_xpos + ui_search_popup_width, ui_search_popup_ypos + ui_search_popup_height, PALETTE_UI_BLACK);
+	// Draw main box outline
+	gfx_Box(ui_search_popup_xpos, ui_search_popup_ypos, ui_search_popup_xpos + ui_search_popup_width, ui_search_popup_ypos + ui_search_popup_height, PALETTE_UI_LGREY);
+	
+	sprintf(msg, "Search: %s_", text);
+	gfx_Puts(ui_search_popup_xpos + 10, ui_search_popup_ypos + 15, ui_font, msg);
+	
+	sprintf(msg, "%u games found - Enter to confirm, Esc to cancel", state->selected_max);
+	gfx_Puts(ui_search_popup_xpos + 10, ui_search_popup_ypos + 45, ui_font, msg);
 	
 	return UI_OK;
 }
@@ -698,7 +734,7 @@ int ui_DrawSplash(){
 	bmpstate_t	*logo_bmpstate;
 	
 	// Load splash logo
-	ui_asset_reader = fopen(splash_logo, "rb");
+	ui_asset_reader = platform_Open(splash_logo, "rb");
 	if (ui_asset_reader == NULL){
 		printf("%s.%d\t ui_DrawSplash() Unable to open file\n", __FILE__, __LINE__);
 		return UI_ERR_FILE;	
@@ -718,6 +754,7 @@ int ui_DrawSplash(){
 		fclose(ui_asset_reader);
 		return UI_ERR_BMP;
 	}
+	logo_bmp->pixels = NULL;
 	// 1b. Allocate enough space for the state structure and line buffer
 	logo_bmpstate = (bmpstate_t *) malloc(sizeof(bmpstate_t));
 	if (logo_bmpstate == NULL){
@@ -792,7 +829,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_select);
 	}
-	ui_asset_reader = fopen(ui_select, "rb");
+	ui_asset_reader = platform_Open(ui_select, "rb");
 	if (ui_asset_reader == NULL){
 			ui_ProgressMessage("ERROR! Unable to open browser select icon file");
 			return UI_ERR_FILE;     
@@ -822,7 +859,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_check_box);
 	}
-	ui_asset_reader = fopen(ui_check_box, "rb");
+	ui_asset_reader = platform_Open(ui_check_box, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open checkbox icon file");
 		return UI_ERR_FILE;     
@@ -851,7 +888,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_check_box_choose);
 	}
-	ui_asset_reader = fopen(ui_check_box_choose, "rb");
+	ui_asset_reader = platform_Open(ui_check_box_choose, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open checkbox chooser icon file");
 		return UI_ERR_FILE;     
@@ -880,7 +917,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_check_box_unchecked);
 	}
-	ui_asset_reader = fopen(ui_check_box_unchecked, "rb");
+	ui_asset_reader = platform_Open(ui_check_box_unchecked, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open checkbox (empty) icon file");
 		return UI_ERR_FILE;     
@@ -910,7 +947,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_title_box);
 	}
-	ui_asset_reader = fopen(ui_title_box, "rb");
+	ui_asset_reader = platform_Open(ui_title_box, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open title text-file");
 		return UI_ERR_FILE;     
@@ -939,7 +976,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_year_box);
 	}
-	ui_asset_reader = fopen(ui_year_box, "rb");
+	ui_asset_reader = platform_Open(ui_year_box, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open year text-file");
 		return UI_ERR_FILE;     
@@ -968,7 +1005,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_genre_box);
 	}
-	ui_asset_reader = fopen(ui_genre_box, "rb");
+	ui_asset_reader = platform_Open(ui_genre_box, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open genre-text file");
 		return UI_ERR_FILE;     
@@ -997,7 +1034,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_company_box);
 	}
-	ui_asset_reader = fopen(ui_company_box, "rb");
+	ui_asset_reader = platform_Open(ui_company_box, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open company-text file");
 		return UI_ERR_FILE;     
@@ -1026,7 +1063,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_series_box);
 	}
-	ui_asset_reader = fopen(ui_series_box, "rb");
+	ui_asset_reader = platform_Open(ui_series_box, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open series-text file");
 		return UI_ERR_FILE;     
@@ -1055,7 +1092,7 @@ int ui_LoadAssets(){
 	if (BMP_VERBOSE){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_path_box);
 	}
-	ui_asset_reader = fopen(ui_path_box, "rb");
+	ui_asset_reader = platform_Open(ui_path_box, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open path-text file");
 		return UI_ERR_FILE;     
@@ -1089,7 +1126,7 @@ int ui_LoadAssets(){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_main);
 	}
 	// 1a. Open file
-	ui_mainstate_reader = fopen(ui_main, "rb");
+	ui_mainstate_reader = platform_Open(ui_main, "rb");
 	if (ui_mainstate_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open main UI bg file");
 		return UI_ERR_FILE;     
@@ -1102,6 +1139,7 @@ int ui_LoadAssets(){
 		fclose(ui_mainstate_reader);
 		return UI_ERR_BMP;
 	}
+	ui_main_bmp->pixels = NULL;
 	// 1c. Allocate enough space for the state structure and line buffer
 	ui_main_bmpstate = (bmpstate_t *) malloc(sizeof(bmpstate_t));
 	if (ui_main_bmpstate == NULL){
@@ -1122,7 +1160,7 @@ int ui_LoadAssets(){
 		printf("%s.%d\t ui_LoadAssets() Loading %s\n", __FILE__, __LINE__, ui_list_box);
 	}
 	// 1a. Open file
-	ui_asset_reader = fopen(ui_list_box, "rb");
+	ui_asset_reader = platform_Open(ui_list_box, "rb");
 	if (ui_asset_reader == NULL){
 		ui_ProgressMessage("ERROR! Unable to open browser bg file");
 		return UI_ERR_FILE;     
@@ -1159,7 +1197,7 @@ int ui_LoadFonts(){
 	// =========================
 	// main font
 	// =========================
-	ui_asset_reader = fopen(ui_font_name, "rb");
+	ui_asset_reader = platform_Open(ui_font_name, "rb");
 	if (ui_asset_reader == NULL){
 		if (UI_VERBOSE){
 				printf("%s.%d\t ui_LoadFonts() Error loading UI font data\n", __FILE__, __LINE__);
@@ -1191,9 +1229,53 @@ int ui_LoadFonts(){
 	// Destroy the temporary bmp structure, as the font is now in a font structure
 	bmp_Destroy(ui_font_bmp);
 	
+	ui_fonts_status = UI_ASSETS_LOADED;
 	return UI_OK;
 }
 
+long int ui_FontBytes(){
+	// Returns the bytes allocated for the font
+	
+	if (ui_fonts_status != UI_ASSETS_LOADED){
+		return 0;
+	}
+	return (long int) sizeof(fontdata_t);
+}
+
+long int ui_AssetBytes(){
+	// Returns the bytes allocated for the UI bitmaps, including their pixels,
+	// and for the line buffer used to draw the main background
+	
+	int i;
+	long int bytes;
+	bmpdata_t *assets[12];
+	
+	if (ui_assets_status != UI_ASSETS_LOADED){
+		return 0;
+	}
+	assets[0] = ui_checkbox_bmp;
+	assets[1] = ui_checkbox_choose_bmp;
+	assets[2] = ui_checkbox_empty_bmp;
+	assets[3] = ui_main_bmp;
+	assets[4] = ui_list_bmp;
+	assets[5] = ui_title_bmp;
+	assets[6] = ui_year_bmp;
+	assets[7] = ui_genre_bmp;
+	assets[8] = ui_company_bmp;
+	assets[9] = ui_series_bmp;
+	assets[10] = ui_select_bmp;
+	assets[11] = ui_path_bmp;
+	
+	bytes = sizeof(bmpstate_t);
+	for(i = 0; i < 12; i++){
+		bytes += sizeof(bmpdata_t);
+		if (assets[i]->pixels != NULL){
+			bytes += assets[i]->size;
+		}
+	}
+	return bytes;
+}
+
 int ui_ProgressMessage(char *c){
 	int x;
 	
@@ -1235,7 +1317,7 @@ int	ui_ReselectCurrentGame(state_t *state){
 	}
 		
 	selected = 0;
-	for(i = startpos; i <= endpos ; i++){
+	for(i = startpos; i < endpos ; i++){
 		gameid = state->selected_list[i];
 		
 		// This is the current selected game
@@ -1360,6 +1442,7 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 	char		info_year[8];
 	char		info_company[32];
 	char		info_path[64];
+	char		game_path[MAX_GAMEPATH_SIZE];
 	char		info_genre[24];
 	char		info_series[24];
 	
@@ -1407,7 +1490,7 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 				// ======================
 				// Unable to load launch.dat	 from disk
 				// ======================
-				sprintf(status_msg, "ERROR: Unable to load metadata file: %s\%s", state->selected_game->path, GAMEDAT);
+				sprintf(status_msg, "ERROR: Unable to load metadata file: %s\%s", getGamePath(state->selected_game, game_path), GAMEDAT);
 				gfx_Bitmap(ui_checkbox_has_metadata_xpos, ui_checkbox_has_metadata_ypos, ui_checkbox_bmp);
 				gfx_Bitmap(ui_checkbox_has_startbat_xpos, ui_checkbox_has_startbat_ypos, ui_checkbox_empty_bmp);
 				gfx_Bitmap(ui_checkbox_has_images_xpos, ui_checkbox_has_images_ypos, ui_checkbox_empty_bmp);
@@ -1418,7 +1501,7 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 				sprintf(info_company, " N/A");
 				sprintf(info_genre, "N/A");
 				sprintf(info_series, "");
-				sprintf(info_path, " %.38s", state->selected_game->path);
+				sprintf(info_path, " %.38s", getGamePath(state->selected_game, game_path));
 			} else {
 				// ======================
 				// Loaded launch.dat from disk
@@ -1537,7 +1620,7 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 				
 				// Number of images/screenshots
 	
-				sprintf(info_path, " %.38s", state->selected_game->path);
+				sprintf(info_path, " %.38s", getGamePath(state->selected_game, game_path));
 			}
 		} else {
 			// ======================
@@ -1554,7 +1637,7 @@ int ui_UpdateInfoPane(state_t *state, gamedata_t *gamedata, launchdat_t *launchd
 			sprintf(info_company, " N/A");
 			sprintf(info_genre, "N/A");
 			sprintf(info_series, "N/A");
-			sprintf(info_path, " %.38s", state->selected_game->path);		
+			sprintf(info_path, " %.38s", getGamePath(state->selected_game, game_path));		
 		}	
 	} else {
 		// ======================
@@ -133,6 +133,12 @@
 #define ui_info_series_text_xpos	438
 #define ui_info_series_text_ypos	358
 
+// search box, drawn over the info pane so the browser stays visible
+#define ui_search_popup_xpos		10
+#define ui_search_popup_ypos		300
+#define ui_search_popup_width	(GFX_COLS - 24)
+#define ui_search_popup_height	80
+
 // launch window popup
 #define ui_launch_popup_xpos		170
 #define ui_launch_popup_ypos		150
@@ -185,7 +191,8 @@
 #define FILTER_PRE_PANE			0x06
 #define FILTER_PANE				0x07
 #define HELP_PANE				0x08
-#define PANE_MAX					0x08
+#define SEARCH_PANE				0x09
+#define PANE_MAX					0x09
 
 // Functions
 void	ui_Init();
@@ -197,6 +204,7 @@ int		ui_DrawConfirmPopup(state_t *state, gamedata_t *gamedata, launchdat_t *laun
 int		ui_DrawFilterPrePopup(state_t *state, int select);
 int		ui_DrawFilterPopup(state_t *state, int select, int redraw, int toggle);
 int		ui_DrawHelpPopup();
+int		ui_DrawSearchPopup(state_t *state, char *text);
 int		ui_DrawLaunchPopup(state_t *state, gamedata_t *gamedata, launchdat_t *launchdat, int toggle);
 int		ui_DrawMainWindow();
 int		ui_DrawSplash();
@@ -208,6 +216,8 @@ int		ui_DisplayArtwork(FILE *screenshot_file, bmpdata_t *screenshot_bmp, bmpstat
 // Asset loaders
 int		ui_LoadAssets();
 int		ui_LoadFonts();
+long int	ui_FontBytes();
+long int	ui_AssetBytes();
 int		ui_LoadScreenshot(char *c);
 
 // Output error or status messages